@@ -0,0 +1,303 @@
+// Copyright (c) 2015-2016 Vittorio Romeo
+// License: Academic Free License ("AFL") v. 3.0
+// AFL License page: http://opensource.org/licenses/AFL-3.0
+// http://vittorioromeo.info | vittorio.romeo@outlook.com
+
+// Headless, reproducible benchmark of the particle simulation.
+
+// Executes the whole system pipeline of `./pres_code.cpp` (including the
+// generation of the circle instances, but without drawing them) for a fixed
+// number of frames and reports mean/p99 step times, per system and total.
+// Every run starts from the same seed. With `--churn N`, every frame
+// creates `N` particles and removes `N` random ones, after the systems have
+// been executed. With `--batch K`, every frame executes the systems `K`
+// times, and only generates the circle instances in the last step. With
+// `--reorder N`, the particles are sorted in spatial order every `N` frames
+// (see `example::reorder_particles`). With `--pipelined 1`, every frame is
+// executed by `example::update_ctx_pipelined`, drawing the vertices of the
+// previous frame to a target that discards them while the systems run; it
+// cannot be combined with churn, batching or reordering.
+
+// Usage:
+/*
+    bench_code [--frames N] [--warmup N] [--seed S]
+               [--counts 5000,20000,50000] [--threads 1,2,4] [--churn N]
+               [--batch K] [--reorder N] [--pipelined 0|1]
+*/
+
+// The spatial partitioning grid is maintained with the default strategy of
+// `./pres_code.cpp`, a parallel rebuild every frame. Define
+// `EXAMPLE_GRID_INCREMENTAL` to measure incremental updates instead.
+
+// The per-system times come from the profiler, which is always enabled:
+// every reported time, including the total, includes its overhead.
+
+// Thread counts are applied by restricting the CPU affinity of the whole
+// process (Linux only), so ECST and the work-stealing pool still spawn one
+// worker per hardware thread, but only run on the first N cores. With
+// `EXAMPLE_PIN_WORKERS`, the workers of the pool are pinned again afterwards,
+// round-robin over those N cores.
+
+#define EXAMPLE_HEADLESS
+#define EXAMPLE_PROFILING
+
+#include "./pres_code.cpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <dirent.h>
+#include <iomanip>
+#include <iostream>
+#include <sched.h>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace bench
+{
+    using example::sz_t;
+
+    struct options
+    {
+        sz_t _frames = 300;
+        sz_t _warmup = 30;
+        std::uint32_t _seed = 1;
+        sz_t _churn = 0;
+        sz_t _batch = 1;
+        sz_t _reorder = 0;
+        bool _pipelined = false;
+        std::vector<sz_t> _counts{5000, 20000, 50000};
+        std::vector<sz_t> _threads;
+    };
+
+    auto parse_list(const char* s)
+    {
+        std::vector<sz_t> result;
+        std::stringstream ss{s};
+
+        for(std::string x; std::getline(ss, x, ',');)
+        {
+            result.emplace_back(std::stoul(x));
+        }
+
+        return result;
+    }
+
+    [[noreturn]] void usage_error(const char* message, const char* option)
+    {
+        std::cerr << message << ": " << option << "\n"
+                  << "usage: bench_code [--frames N] [--warmup N] [--seed S]\n"
+                  << "                  [--counts 5000,20000,50000] "
+                     "[--threads 1,2,4] [--churn N]\n"
+                  << "                  [--batch K] [--reorder N] "
+                     "[--pipelined 0|1]\n";
+
+        std::exit(1);
+    }
+
+    auto parse_options(int argc, char** argv)
+    {
+        options o;
+
+        for(int i = 1; i < argc; i += 2)
+        {
+            const char* k = argv[i];
+            if(i + 1 == argc) usage_error("missing value", k);
+
+            const char* v = argv[i + 1];
+
+            if(!std::strcmp(k, "--frames")) o._frames = std::stoul(v);
+            else if(!std::strcmp(k, "--warmup")) o._warmup = std::stoul(v);
+            else if(!std::strcmp(k, "--seed")) o._seed = std::stoul(v);
+            else if(!std::strcmp(k, "--churn")) o._churn = std::stoul(v);
+            else if(!std::strcmp(k, "--batch")) o._batch = std::stoul(v);
+            else if(!std::strcmp(k, "--reorder")) o._reorder = std::stoul(v);
+            else if(!std::strcmp(k, "--pipelined"))
+                o._pipelined = std::stoul(v) != 0;
+            else if(!std::strcmp(k, "--counts")) o._counts = parse_list(v);
+            else if(!std::strcmp(k, "--threads")) o._threads = parse_list(v);
+            else
+            {
+                usage_error("unknown option", k);
+            }
+        }
+
+        if(o._pipelined && (o._churn != 0 || o._batch != 1 || o._reorder != 0))
+        {
+            std::cerr << "--pipelined cannot be combined with --churn, "
+                         "--batch or --reorder\n";
+            std::exit(1);
+        }
+
+        // Default thread counts: powers of two, up to all hardware threads.
+        if(o._threads.empty())
+        {
+            const sz_t hw = std::max(std::thread::hardware_concurrency(), 1u);
+            for(sz_t t = 1; t < hw; t *= 2) o._threads.emplace_back(t);
+            o._threads.emplace_back(hw);
+        }
+
+        return o;
+    }
+
+    // Render target that discards everything drawn to it, used by
+    // `--pipelined`.
+    struct null_target
+    {
+        template <typename... Ts>
+        void draw(const Ts&...) noexcept
+        {
+        }
+    };
+
+    // Restricts every thread of the process to the first `n` CPUs.
+    void restrict_cpus(sz_t n)
+    {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        for(sz_t i = 0; i < n && i < CPU_SETSIZE; ++i) CPU_SET(i, &set);
+
+        auto* dir = opendir("/proc/self/task");
+        if(dir == nullptr) return;
+
+        while(auto* entry = readdir(dir))
+        {
+            if(entry->d_name[0] == '.') continue;
+            sched_setaffinity(std::atoi(entry->d_name), sizeof(set), &set);
+        }
+
+        closedir(dir);
+    }
+
+    template <typename TContext>
+    void run(const options& o, TContext& ctx, sz_t threads, sz_t count)
+    {
+        using clock = std::chrono::steady_clock;
+        constexpr example::ft dt = 1.f;
+
+        auto& profiler = example::profiler::registry::instance();
+        example::dense_entities particles;
+        sz_t frame = 0;
+
+        // Entities have to be created before removing any in the same step.
+        auto churn = [&o, &particles, &frame](auto& proxy)
+        {
+            example::mk_random_particles(proxy, particles, o._churn);
+
+            for(sz_t i = 0; i < o._churn; ++i)
+            {
+                auto eid = example::random_index(particles.size());
+                example::kill_particle(proxy, particles, ecst::entity_id(eid));
+            }
+
+            if(o._reorder != 0 && ++frame % o._reorder == 0)
+            {
+                EXAMPLE_PROFILE_SCOPE("reorder_particles");
+                example::reorder_particles(proxy, particles);
+            }
+        };
+
+        example::frame_pipeline pipeline;
+        null_target target;
+
+        auto run_frame = [&]
+        {
+            if(o._pipelined)
+            {
+                example::update_ctx_pipelined(ctx, target, dt, pipeline);
+                return;
+            }
+
+            example::step_ctx_n(ctx, dt, o._batch, 1.f, churn);
+        };
+
+        example::seed_random(o._seed);
+        example::init_ctx(ctx, particles, count);
+
+        for(sz_t i = 0; i < o._warmup; ++i)
+        {
+            run_frame();
+        }
+
+        profiler.clear();
+
+        std::vector<double> totals;
+        totals.reserve(o._frames);
+
+        for(sz_t i = 0; i < o._frames; ++i)
+        {
+            const auto begin = clock::now();
+            run_frame();
+            const auto end = clock::now();
+
+            totals.emplace_back(
+                std::chrono::duration<double, std::milli>(end - begin)
+                    .count());
+        }
+
+        auto print_row = [&](const auto& name, double mean, double p99)
+        {
+            std::cout << std::right << std::setw(8) << threads
+                      << std::setw(10) << count << "  " << std::left
+                      << std::setw(24) << name << std::right << std::fixed
+                      << std::setprecision(3) << std::setw(10) << mean
+                      << std::setw(10) << p99 << "\n";
+        };
+
+        profiler.for_statistics(
+            [&](const auto& name, auto mean, auto, auto, auto p99)
+            {
+                print_row(name, mean, p99);
+            });
+
+        std::sort(totals.begin(), totals.end());
+
+        double sum = 0;
+        for(auto x : totals) sum += x;
+
+        print_row("(total step)", sum / totals.size(),
+            totals[static_cast<sz_t>(0.99 * (totals.size() - 1))]);
+    }
+}
+
+int main(int argc, char** argv)
+{
+    const auto o = bench::parse_options(argc, argv);
+
+    std::cout << "# EXAMPLE_PROFILING is enabled: the times include the "
+                 "overhead of recording\n# the profiling events.\n";
+
+    std::cout << std::right << std::setw(8) << "threads" << std::setw(10)
+              << "particles"
+              << "  " << std::left << std::setw(24) << "system" << std::right
+              << std::setw(10) << "mean ms" << std::setw(10) << "p99 ms"
+              << "\n";
+
+    constexpr auto s = example::ecst_setup::make_settings();
+
+    for(auto t : o._threads)
+    {
+        for(auto n : o._counts)
+        {
+            if(!example::fits_in_storage(n + o._churn))
+            {
+                std::cerr << "skipping " << n << " particles: above the "
+                          << "entity limit\n";
+
+                continue;
+            }
+
+            // Make sure the workers of the shared pool exist before
+            // restricting the affinity of every thread.
+            (void)example::default_work_stealing_pool();
+
+            auto ctx = ecst::context::make_uptr(s);
+            bench::restrict_cpus(t);
+            example::default_work_stealing_pool().pin_workers();
+            bench::run(o, *ctx, t, n);
+        }
+    }
+}
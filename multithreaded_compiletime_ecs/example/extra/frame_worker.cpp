@@ -0,0 +1,104 @@
+// Copyright (c) 2015-2016 Vittorio Romeo
+// License: Academic Free License ("AFL") v. 3.0
+// AFL License page: http://opensource.org/licenses/AFL-3.0
+// http://vittorioromeo.info | vittorio.romeo@outlook.com
+
+#include <cassert>
+#include <chrono>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+#include "../utils/frame_worker.hpp"
+
+using example::frame_worker;
+
+void test_pipeline()
+{
+    // Every "frame" produces a value on the worker while the calling thread
+    // consumes the one of the previous frame, like `update_ctx_pipelined`.
+    frame_worker w;
+
+    int ready = -1;
+    int pending = -1;
+    std::vector<int> consumed;
+
+    for(int frame = 0; frame < 1000; ++frame)
+    {
+        auto job = [&pending, frame]
+        {
+            pending = frame;
+        };
+
+        w.start(job);
+        if(ready >= 0) consumed.emplace_back(ready);
+        w.wait();
+
+        ready = pending;
+    }
+
+    assert(consumed.size() == 999);
+    for(int i = 0; i < 999; ++i)
+    {
+        assert(consumed[i] == i);
+    }
+}
+
+void test_exception()
+{
+    // Exceptions are rethrown by `wait`, and the worker stays usable.
+    frame_worker w;
+
+    auto failing = []
+    {
+        throw std::runtime_error{"failed"};
+    };
+
+    w.start(failing);
+
+    bool thrown = false;
+    try
+    {
+        w.wait();
+    }
+    catch(const std::runtime_error&)
+    {
+        thrown = true;
+    }
+
+    assert(thrown);
+
+    int x = 0;
+    auto job = [&x]
+    {
+        x = 1;
+    };
+
+    w.start(job);
+    w.wait();
+    assert(x == 1);
+}
+
+void test_destroy_while_busy()
+{
+    // The destructor waits for the current job.
+    int x = 0;
+    auto job = [&x]
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        x = 1;
+    };
+
+    {
+        frame_worker w;
+        w.start(job);
+    }
+
+    assert(x == 1);
+}
+
+int main()
+{
+    test_pipeline();
+    test_exception();
+    test_destroy_while_busy();
+}
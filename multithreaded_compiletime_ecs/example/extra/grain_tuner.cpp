@@ -0,0 +1,107 @@
+// Copyright (c) 2015-2016 Vittorio Romeo
+// License: Academic Free License ("AFL") v. 3.0
+// AFL License page: http://opensource.org/licenses/AFL-3.0
+// http://vittorioromeo.info | vittorio.romeo@outlook.com
+
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <cstddef>
+#include <iostream>
+#include <thread>
+#include "../utils/grain_tuner.hpp"
+
+using example::grain_tuner;
+
+// Grain that makes a block take `target_block_ns` with the given cost.
+constexpr std::size_t expected_grain(double ns_per_item) noexcept
+{
+    return static_cast<std::size_t>(
+        grain_tuner::target_block_ns / ns_per_item);
+}
+
+void test_record()
+{
+    // 100000 items costing 500ns each, ran by 4 threads: the blocks took
+    // 50ms in total, whatever the wall time of the call was.
+    grain_tuner t{256, 1, 100000};
+    t.record(100000, 4, 100000 * 500.0);
+
+    assert(t.grain() == expected_grain(500));
+}
+
+void test_bounds()
+{
+    // Cheap items: the grain is limited by the bounds and by the number of
+    // blocks per thread.
+    grain_tuner t{256, 1, 4096};
+    t.record(100000, 4, 100000 * 1.0);
+    assert(t.grain() == 4096);
+
+    grain_tuner t2{256, 1, 100000};
+    t2.record(1000, 4, 1000 * 1.0);
+    assert(t2.grain() == 1000 / (4 * grain_tuner::blocks_per_thread));
+
+    // Expensive items never go below the minimum.
+    grain_tuner t3{256, 8, 4096};
+    t3.record(100000, 4, 100000 * 1e6);
+    assert(t3.grain() == 8);
+}
+
+void test_hysteresis()
+{
+    grain_tuner t{100, 1, 100000};
+
+    // Within 25% of the current grain: no change.
+    t.record(100000, 4, 100000 * (grain_tuner::target_block_ns / 110));
+    assert(t.grain() == 100);
+}
+
+void test_measured()
+{
+    using clock = std::chrono::steady_clock;
+    constexpr double ns_per_item = 500;
+
+    // Spins for `ns_per_item` per item.
+    auto body = [](std::size_t b, std::size_t e)
+    {
+        const auto end = clock::now() +
+                         std::chrono::nanoseconds(
+                             static_cast<long long>(ns_per_item * (e - b)));
+
+        while(clock::now() < end)
+        {
+        }
+    };
+
+    // More threads than cores would preempt blocks in the middle of their
+    // timing.
+    const std::size_t threads =
+        std::min(std::thread::hardware_concurrency(), 4u);
+
+    example::work_stealing_pool pool{
+        std::max(threads, std::size_t(1)), example::thread_affinity::none};
+    grain_tuner t{256, 1, 100000};
+
+    for(int i = 0; i < 10; ++i)
+    {
+        t.parallel_for(pool, 100000, body);
+    }
+
+    // Timing overhead and preemption only make items look more expensive:
+    // allow a factor of two below the exact grain.
+    const auto g = t.grain();
+    std::cout << "measured grain: " << g << " (expected "
+              << expected_grain(ns_per_item) << ")" << std::endl;
+
+    assert(g <= expected_grain(ns_per_item) * 5 / 4);
+    assert(g >= expected_grain(ns_per_item) / 2);
+}
+
+int main()
+{
+    test_record();
+    test_bounds();
+    test_hysteresis();
+    test_measured();
+}
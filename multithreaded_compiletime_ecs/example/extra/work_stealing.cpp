@@ -0,0 +1,61 @@
+// Copyright (c) 2015-2016 Vittorio Romeo
+// License: Academic Free License ("AFL") v. 3.0
+// AFL License page: http://opensource.org/licenses/AFL-3.0
+// http://vittorioromeo.info | vittorio.romeo@outlook.com
+
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <thread>
+#include <vector>
+#include "../utils/work_stealing.hpp"
+
+using example::thread_affinity;
+using example::work_stealing_pool;
+
+// Every index is processed exactly once, for any thread count.
+void test_coverage(thread_affinity affinity)
+{
+    for(std::size_t threads : {1, 2, 4})
+    {
+        work_stealing_pool pool{threads, affinity};
+
+        for(int i = 0; i < 100; ++i)
+        {
+            std::vector<std::atomic<int>> hits(1000);
+            pool.parallel_for(1000, 7, [&hits](auto b, auto e)
+                {
+                    for(auto k = b; k < e; ++k) ++hits[k];
+                });
+
+            for(const auto& h : hits) assert(h == 1);
+        }
+    }
+}
+
+// With pinned workers, the calling thread only waits.
+void test_pinned_caller()
+{
+    work_stealing_pool pool{2, thread_affinity::pinned};
+    pool.pin_workers();
+
+    const auto caller = std::this_thread::get_id();
+    std::atomic<bool> ran_on_caller{false};
+
+    for(int i = 0; i < 100; ++i)
+    {
+        pool.parallel_for(1000, 1, [&](auto, auto)
+            {
+                if(std::this_thread::get_id() == caller) ran_on_caller = true;
+            });
+    }
+
+    assert(!ran_on_caller);
+}
+
+int main()
+{
+    test_coverage(thread_affinity::none);
+    test_coverage(thread_affinity::pinned);
+    test_pinned_caller();
+}
@@ -3,7 +3,22 @@
 // AFL License page: http://opensource.org/licenses/AFL-3.0
 // http://vittorioromeo.info | vittorio.romeo@outlook.com
 
+#include <tuple>
 #include "./utils/dependencies.hpp"
+#include "./utils/circle_instances.hpp"
+#include "./utils/dense_entities.hpp"
+#include "./utils/entity_chunks.hpp"
+#include "./utils/frame_arena.hpp"
+#include "./utils/frame_worker.hpp"
+#include "./utils/grain_tuner.hpp"
+#include "./utils/morton.hpp"
+#include "./utils/profiler.hpp"
+#include "./utils/random.hpp"
+#include "./utils/segmented_output.hpp"
+#include "./utils/fused_system.hpp"
+#include "./utils/simd_kernels.hpp"
+#include "./utils/system_graph.hpp"
+#include "./utils/work_stealing.hpp"
 
 // The following example consists in a particle simulations. All particles are
 // massless and collide with each other in a perfectly inelastic way. The
@@ -12,6 +27,7 @@
 // Every particle will have the following components:
 /*  
     * Position (2D float vector).
+    * Previous position (2D float vector), for interpolated rendering.
     * Velocity (2D float vector).
     * Acceleration (2D float vector).
     * Color (SFML color struct).
@@ -20,43 +36,61 @@
 
 // The following systems will execute the simulation:
 /*
-    * Acceleration: accelerates the particles.
+    * Integration: fusion of the following three systems, which form a chain
+                   over the same particles. Executes all of them in a single
+                   pass over the entities.
       (inner parallelism allowed)
       (no dependencies)
+
+        * Acceleration: accelerates the particles.
  
-    * Velocity: moves the particles.
-      (inner parallelism allowed)
-      (depends on: Acceleration)
+        * Velocity: moves the particles.
  
-    * Keep in bounds: prevents the particles from leaving the simulation's
-                      boundaries.
-      (inner parallelism allowed)
-      (depends on: Velocity)
+        * Keep in bounds: prevents the particles from leaving the
+                          simulation's boundaries.
  
     * Spatial partition: partitions the simulation space in a 2D grid to speed
                          up broadphase collision detection. Produces lists of
                          {entity_id; grid_index} pairs that will be later
                          evaluated to fill the 2D grid.
       (inner parallelism allowed)
-      (depends on: Keep in bounds)
+      (depends on: Integration)
  
-    * Spatial filler: reads the pairs produced by Spatial partition and fills
-                      the 2D grid data structure.
+    * Spatial offsets: reads the per-cell counts produced by Spatial partition
+                       and computes the offsets at which every subtask will
+                       write its pairs in the 2D grid.
       (inner parallelism disallowed)
       (depends on: Spatial partition)
  
+    * Spatial filler: scatters the pairs produced by Spatial partition in the
+                      2D grid data structure, one subtask output at a time.
+                      With incremental grid updates, only the particles that
+                      changed cell are moved, by a single task.
+      (inner parallelism allowed)
+      (depends on: Spatial offsets)
+ 
     * Collision: detects collisions between particles and produces lists of
                  contacts that will be later evaluated to solve the collisions.
+                 Every pair of neighboring particles is tested once.
       (inner parallelism allowed)
       (depends on: Spatial filler)
  
-    * Solve contacts: reads the contacts produced by Collision and solves them
-                      by moving particles and changing their velocities.
+    * Contact islands: reads the contacts produced by Collision in place,
+                       through a single view over all of them, and groups
+                       them in "islands" of contacts that do not share any
+                       particle with other islands.
       (inner parallelism disallowed)
       (depends on: Collision)
  
-    * Render colored circle: produces lists of vertices that will be rendered
-                             later on the SFML RenderWindow.
+    * Solve contacts: solves the islands built by Contact islands by moving
+                      particles and changing their velocities.
+      (inner parallelism allowed)
+      (depends on: Contact islands)
+ 
+    * Render colored circle: produces lists of circle instances that will be
+                             rendered later on the SFML RenderWindow. Only
+                             records the positions of the particles in the
+                             steps that are not rendered.
       (inner parallelism allowed)
       (depends on: Solve contacts)
 */
@@ -69,6 +103,204 @@ namespace example
     constexpr auto top_bound = 0;
     constexpr auto bottom_bound = 768;
 
+    // Radius range of the particles.
+    constexpr auto min_radius = 1.f;
+    constexpr auto max_radius = 4.f;
+
+    // Scheduling strategies for the systems whose per-entity cost is uneven.
+    namespace sched
+    {
+        // Uses ECST's inner parallelism, splitting the entities evenly
+        // across the available cores.
+        struct s_split_evenly
+        {
+        };
+
+        // Runs the system as a single ECST task, that splits its entities
+        // adaptively on a work-stealing pool.
+        struct s_work_stealing
+        {
+        };
+    }
+
+    // Scheduling strategy of the "Collision" system.
+    // Define `EXAMPLE_SPLIT_EVENLY` to A/B against ECST's even split.
+#if defined(EXAMPLE_SPLIT_EVENLY)
+    using collision_scheduler = sched::s_split_evenly;
+#else
+    using collision_scheduler = sched::s_work_stealing;
+#endif
+
+    // Broadphase strategies of the "Collision" system.
+    namespace broadphase
+    {
+        // Every particle is assigned to all the cells its circle overlaps,
+        // and is tested against the particles of the cell containing its
+        // center.
+        struct bp_overlapped_cells
+        {
+        };
+
+        // Every particle is assigned to the cell containing its center only,
+        // and every cell is tested against itself and half of its neighbors:
+        // each pair of particles is tested exactly once per frame.
+        struct bp_cell_pairs
+        {
+        };
+    }
+
+    // Broadphase strategy of the "Collision" system.
+    // Define `EXAMPLE_OVERLAPPED_CELLS` to A/B against the previous one.
+#if defined(EXAMPLE_OVERLAPPED_CELLS)
+    using collision_broadphase = broadphase::bp_overlapped_cells;
+#else
+    using collision_broadphase = broadphase::bp_cell_pairs;
+#endif
+
+    // Maintenance strategies of the spatial partitioning grid.
+    namespace grid
+    {
+        // The grid is cleared and rebuilt from scratch every frame.
+        struct g_rebuild
+        {
+        };
+
+        // The grid remembers the cell of every entity, and only the entities
+        // that changed cell since the previous frame are moved. Requires
+        // `broadphase::bp_cell_pairs`.
+        struct g_incremental
+        {
+        };
+    }
+
+    // Maintenance strategy of the spatial partitioning grid. Rebuilds are
+    // filled and scanned in parallel, while incremental updates are applied
+    // by a single subtask.
+    // Define `EXAMPLE_GRID_INCREMENTAL` to A/B against incremental updates.
+#if defined(EXAMPLE_GRID_INCREMENTAL) && !defined(EXAMPLE_OVERLAPPED_CELLS)
+    using grid_update = grid::g_incremental;
+#else
+    using grid_update = grid::g_rebuild;
+#endif
+
+    // Entity storage strategies of the context.
+    namespace storage
+    {
+        // Storage for `entity_limit` entities is allocated up front.
+        struct s_fixed
+        {
+        };
+
+        // Storage starts with room for `entity_storage_chunk` entities, and
+        // grows when needed. Removed particles are compacted (see
+        // `kill_particle`), so the used storage follows the number of live
+        // particles.
+        struct s_dynamic
+        {
+        };
+    }
+
+    // Entity storage strategy of the context.
+    // Define `EXAMPLE_FIXED_STORAGE` to A/B against worst-case storage.
+#if defined(EXAMPLE_FIXED_STORAGE)
+    using entity_storage = storage::s_fixed;
+#else
+    using entity_storage = storage::s_dynamic;
+#endif
+
+    // Frame execution strategies of `update_ctx`.
+    namespace frames
+    {
+        // The systems of a frame are executed, then its circle instances are
+        // drawn.
+        struct f_serial
+        {
+        };
+
+        // The systems of a frame are executed on a worker thread while the
+        // circle instances of the previous frame are drawn (see
+        // `update_ctx_pipelined`).
+        struct f_pipelined
+        {
+        };
+    }
+
+    // Frame execution strategy of `update_ctx`.
+    // Define `EXAMPLE_PIPELINED_FRAMES` to A/B against pipelined frames.
+#if defined(EXAMPLE_PIPELINED_FRAMES)
+    using frame_execution = frames::f_pipelined;
+#else
+    using frame_execution = frames::f_serial;
+#endif
+
+    // Grain strategies of the work-stealing blocks of the "Collision"
+    // system, with `sched::s_work_stealing`.
+    namespace granularity
+    {
+        // Blocks always have the initial grain.
+        struct g_fixed
+        {
+        };
+
+        // The grain follows the measured cost of the previous frames (see
+        // `grain_tuner`). Contacts are consumed in block order, so the
+        // result does not depend on the grain.
+        struct g_tuned
+        {
+        };
+    }
+
+    // Grain strategy of the "Collision" system.
+    // Define `EXAMPLE_FIXED_GRAIN` to A/B against a fixed grain.
+#if defined(EXAMPLE_FIXED_GRAIN)
+    using collision_grain = granularity::g_fixed;
+#else
+    using collision_grain = granularity::g_tuned;
+#endif
+
+    // Returns a tuner starting from `initial`, that keeps it...
+    inline auto make_grain_tuner(
+        granularity::g_fixed, sz_t initial, sz_t, sz_t)
+    {
+        return grain_tuner{initial, initial, initial};
+    }
+
+    // ...or that moves it within `[min_grain, max_grain]`.
+    inline auto make_grain_tuner(
+        granularity::g_tuned, sz_t initial, sz_t min_grain, sz_t max_grain)
+    {
+        return grain_tuner{initial, min_grain, max_grain};
+    }
+
+    // Orders in which the "Contact islands" system gathers the contacts.
+    namespace contact_order
+    {
+        // Contacts are read in place from the outputs of the "Collision"
+        // subtasks, in output order.
+        struct o_output
+        {
+        };
+
+        // Contacts are gathered in a buffer sorted by `(_e0, _e1)` in
+        // parallel: contacts of the same particle are solved together.
+        struct o_sorted
+        {
+        };
+    }
+
+    // Contact gathering order of the "Contact islands" system.
+    // Define `EXAMPLE_SORTED_CONTACTS` to A/B against sorted contacts.
+#if defined(EXAMPLE_SORTED_CONTACTS)
+    using contact_gathering = contact_order::o_sorted;
+#else
+    using contact_gathering = contact_order::o_output;
+#endif
+
+    static_assert(std::is_same<grid_update, grid::g_rebuild>{} ||
+                      std::is_same<collision_broadphase,
+                          broadphase::bp_cell_pairs>{},
+        "incremental grid updates require one cell per entity");
+
     // Data of a collision contact.
     // Produced by the "Collision" system.
     struct contact
@@ -80,16 +312,36 @@ namespace example
         float _dist;
     };
 
+    // Output of a single "Collision" subtask: one segment per work-stealing
+    // block (see `./utils/segmented_output.hpp`).
+    using contact_output = segmented_output<contact>;
+
     // Data for the assignment of an entity to a cell of the spatial
-    // partitioning grid.
+    // partitioning grid. With `grid::g_incremental`, only produced for the
+    // entities that changed cell.
     // Produced by the "Spatial partition" system.
     struct sp_data
     {
         // Entity ID to add.
         ecst::entity_id _e;
 
-        // Cell coordinates.
-        sz_t _cell_x, _cell_y;
+        // Linear (row-major) index of the target cell.
+        sz_t _cell;
+    };
+
+    // Output of a single "Spatial partition" subtask.
+    struct sp_output
+    {
+        // Cell assignments produced by the subtask.
+        arena_segment<sp_data> _entries;
+
+        // Number of entries per cell. Turned into per-cell write cursors by
+        // the "Spatial offsets" system. Unused with `grid::g_incremental`.
+        std::vector<sz_t> _cells;
+
+        // One past the largest entity ID of the entries. Unused with
+        // `grid::g_incremental`.
+        sz_t _id_end{0};
     };
 
     // Component definitions.
@@ -104,6 +356,12 @@ namespace example
             vec2f _v;
         };
 
+        // Position at the end of the previous step.
+        struct previous_position
+        {
+            vec2f _v;
+        };
+
         struct velocity
         {
             vec2f _v;
@@ -143,6 +401,7 @@ namespace example
     EXAMPLE_COMPONENT_TAG(acceleration);
     EXAMPLE_COMPONENT_TAG(velocity);
     EXAMPLE_COMPONENT_TAG(position);
+    EXAMPLE_COMPONENT_TAG(previous_position);
     EXAMPLE_COMPONENT_TAG(circle);
     EXAMPLE_COMPONENT_TAG(color);
 
@@ -153,12 +412,12 @@ namespace example
     */
 
     // System tags, in namespace `example::st`.
-    EXAMPLE_SYSTEM_TAG(acceleration);
-    EXAMPLE_SYSTEM_TAG(velocity);
-    EXAMPLE_SYSTEM_TAG(keep_in_bounds);
+    EXAMPLE_SYSTEM_TAG(integration);
     EXAMPLE_SYSTEM_TAG(spatial_partition);
+    EXAMPLE_SYSTEM_TAG(spatial_offsets);
     EXAMPLE_SYSTEM_TAG(spatial_filler);
     EXAMPLE_SYSTEM_TAG(collision);
+    EXAMPLE_SYSTEM_TAG(contact_islands);
     EXAMPLE_SYSTEM_TAG(solve_contacts);
     EXAMPLE_SYSTEM_TAG(render_colored_circle);
 
@@ -187,14 +446,26 @@ namespace example
                 // Notice that the code below does not know anything about the
                 // multithreading strategy employed by the system: the same
                 // syntax works with any kind (or lack) of parallel execution.
-                data.for_entities([&](auto eid)
-                    {
-                        auto& v = data.get(ct::velocity, eid)._v;
-                        const auto& a = data.get(ct::acceleration, eid)._v;
 
-                        v += a * dt;
+                // Entities are processed in chunks of contiguous component
+                // storage, which allows the use of SIMD kernels.
+                for_entity_chunks(data, [this, dt](auto& chunk)
+                    {
+                        this->process_chunk(dt, chunk);
                     });
             }
+
+            // Kernel executed on a chunk of entities. Also used when the
+            // system is fused with others.
+            template <typename TChunk>
+            void process_chunk(ft dt, TChunk& chunk) noexcept
+            {
+                auto* v = simd::as_floats(chunk.get(ct::velocity));
+                const auto* a = simd::as_floats(chunk.get(ct::acceleration));
+
+                // `v += a * dt`
+                simd::multiply_add(v, a, dt, chunk.size());
+            }
         };
 
         // This system moves the subscribed particles.
@@ -203,14 +474,21 @@ namespace example
             template <typename TData>
             void process(ft dt, TData& data)
             {
-                data.for_entities([&](auto eid)
+                for_entity_chunks(data, [this, dt](auto& chunk)
                     {
-                        auto& p = data.get(ct::position, eid)._v;
-                        const auto& v = data.get(ct::velocity, eid)._v;
-
-                        p += v * dt;
+                        this->process_chunk(dt, chunk);
                     });
             }
+
+            template <typename TChunk>
+            void process_chunk(ft dt, TChunk& chunk) noexcept
+            {
+                auto* p = simd::as_floats(chunk.get(ct::position));
+                const auto* v = simd::as_floats(chunk.get(ct::velocity));
+
+                // `p += v * dt`
+                simd::multiply_add(p, v, dt, chunk.size());
+            }
         };
 
         // This system keeps the particles in the simulation bounds.
@@ -219,49 +497,37 @@ namespace example
             template <typename TData>
             void process(TData& data)
             {
-                data.for_entities([&](auto eid)
+                for_entity_chunks(data, [this](auto& chunk)
                     {
-                        auto& p = data.get(ct::position, eid)._v;
-                        auto& v = data.get(ct::velocity, eid)._v;
-                        const auto& radius = data.get(ct::circle, eid)._radius;
+                        this->process_chunk(chunk);
+                    });
+            }
 
-                        // Calculate the edge positions of the particle.
-                        auto left = p.x - radius;
-                        auto right = p.x + radius;
-                        auto top = p.y - radius;
-                        auto bottom = p.y + radius;
+            template <typename TChunk>
+            void process_chunk(TChunk& chunk) noexcept
+            {
+                constexpr simd::bounds bounds{
+                    left_bound, top_bound, right_bound, bottom_bound};
 
-                        // Move and invert X velocity if necessary.
-                        if(left < left_bound)
-                        {
-                            p.x = left_bound + radius;
-                            v.x *= -1;
-                        }
-                        else if(right > right_bound)
-                        {
-                            p.x = right_bound - radius;
-                            v.x *= -1;
-                        }
+                auto* p = simd::as_floats(chunk.get(ct::position));
+                auto* v = simd::as_floats(chunk.get(ct::velocity));
+                const auto* r = simd::as_floats(chunk.get(ct::circle));
 
-                        // Move and invert Y velocity if necessary.
-                        if(top < top_bound)
-                        {
-                            p.y = top_bound + radius;
-                            v.y *= -1;
-                        }
-                        else if(bottom > bottom_bound)
-                        {
-                            p.y = bottom_bound - radius;
-                            v.y *= -1;
-                        }
-                    });
+                // Move the particles back in bounds and invert their
+                // velocity where necessary.
+                simd::reflect_in_bounds(p, v, r, chunk.size(), bounds);
             }
         };
 
+        // The three systems above always run one after another on the same
+        // particles: they are fused in a single system, that executes the
+        // kernels of all of them on a chunk before moving to the next one.
+        using integration = fused<acceleration, velocity, keep_in_bounds>;
+
         // This system stores a spatial partitioning grid (to speed-up
-        // broadphase collision detection) and outputs a vector of `sp_data`,
-        // which is used in a later step to actually fill the spatial
-        // partitioning grid.
+        // broadphase collision detection) and outputs a vector of `sp_data`
+        // plus per-cell counts, which are used in later steps to actually
+        // fill the spatial partitioning grid.
         struct spatial_partition
         {
             // Partitioning constants.
@@ -276,257 +542,1523 @@ namespace example
 
             static constexpr sz_t cell_count = grid_width * grid_height;
 
-            // The grid is a simple 1D array of cells.
-            // A cell is a vector of entity IDs.
-            using cell_type = std::vector<ecst::entity_id>;
-            std::array<std::array<cell_type, grid_height>, grid_width> _grid;
+            // Upper bound of the number of cells overlapped by a particle.
+            static constexpr sz_t max_cells_per_axis =
+                static_cast<sz_t>(max_radius * 2) / cell_size + 2;
+
+            // Upper bound of the number of cells a particle is assigned to.
+            static constexpr sz_t max_cells_per_entity =
+                std::is_same<collision_broadphase,
+                    broadphase::bp_cell_pairs>{}
+                    ? 1
+                    : max_cells_per_axis * max_cells_per_axis;
+
+            // With `bp_cell_pairs`, particles can only collide with the ones
+            // in the same cell or in the 8 surrounding cells.
+            static_assert(max_radius * 2 <= cell_size, "");
+
+            // Storage for the `sp_data` outputs of the subtasks.
+            frame_arena<sp_data> _arena;
+
+            // The grid is stored in "compressed sparse row" form: the entity
+            // IDs of every cell are kept in a single contiguous buffer, sorted
+            // by cell, and each cell is described by an offset into it.
+            // Cells are laid out row-major, matching the access pattern of
+            // the `collision` system.
+            // Cell `i` owns the slots in `[_offsets[i], _offsets[i + 1])`,
+            // of which `[_offsets[i], _ends[i])` are used. Free slots only
+            // exist with `grid::g_incremental`.
+            std::vector<ecst::entity_id> _entities;
+            std::array<sz_t, cell_count + 1> _offsets{};
+            std::array<sz_t, cell_count> _ends{};
+
+            // State of `grid::g_incremental`: cell and slot of every entity
+            // in the grid, indexed by entity ID. With `grid::g_rebuild` and
+            // `bp_cell_pairs`, only the slots are kept, for `collision`.
+            static constexpr auto npos = std::numeric_limits<sz_t>::max();
+            std::vector<sz_t> _cell_of;
+            std::vector<sz_t> _slot_of;
+
+            // Entities that did not fit in the free slots of their new cell,
+            // and storage used to lay out the grid again when there are any.
+            std::vector<ecst::entity_id> _overflowed;
+            std::vector<ecst::entity_id> _relayout_entities;
+            std::vector<sz_t> _relayout_offsets;
+
+            // Minimum number of free slots per cell after a relayout.
+            static constexpr sz_t min_free_slots = 2;
+
+            // Cells per block of the parallel scan of `prefix_sum`, and first
+            // slot of every block (followed by the total).
+            static constexpr sz_t scan_block_cells = 1024;
+            static constexpr sz_t scan_block_count =
+                (cell_count + scan_block_cells - 1) / scan_block_cells;
+
+            std::array<sz_t, scan_block_count + 1> _block_offsets{};
+
+            // Subtask outputs waiting to be scattered in the grid, and index
+            // of the next one to be claimed by a "Spatial filler" subtask.
+            std::vector<sp_output*> _pending;
+            std::atomic<sz_t> _next_pending{0};
+
+            // Non-owning view over the entity IDs of a single cell.
+            class cell_view
+            {
+            private:
+                const ecst::entity_id* _begin;
+                const ecst::entity_id* _end;
+
+            public:
+                cell_view(const ecst::entity_id* b,
+                    const ecst::entity_id* e) noexcept : _begin{b},
+                                                         _end{e}
+                {
+                }
+
+                auto begin() const noexcept
+                {
+                    return _begin;
+                }
+
+                auto end() const noexcept
+                {
+                    return _end;
+                }
+
+                auto size() const noexcept
+                {
+                    return static_cast<sz_t>(_end - _begin);
+                }
+            };
 
             // Clear all cells from the particles.
+            // Only the offsets need to be reset: the entity buffer keeps its
+            // capacity between frames.
             void clear_cells() noexcept
             {
-                for(auto& y : _grid)
-                {
-                    for(auto& c : y)
-                    {
-                        c.clear();
-                    }
-                }
+                _offsets.fill(0);
+                _ends.fill(0);
+                _entities.clear();
             }
 
-            auto& cell_by_idxs(sz_t x, sz_t y) noexcept
+            // Prepares the grid for a new frame.
+            void begin_frame(grid::g_rebuild) noexcept
             {
-                return _grid[x + offset][y + offset];
+                clear_cells();
             }
 
-            // Given an `sp_data`, emplaces an entity ID in a target cell.
-            void add_sp(const sp_data& x)
+            void begin_frame(grid::g_incremental) noexcept
             {
-                cell_by_idxs(x._cell_x, x._cell_y).emplace_back(x._e);
             }
 
-            // From world coordinates to cell index.
-            auto idx(float x) noexcept
+            void begin_frame() noexcept
             {
-                return x / cell_size;
+                begin_frame(grid_update{});
             }
 
-            // Returns the cell containing the position `p`.
-            auto& cell_by_pos(const vec2f& p) noexcept
+            static constexpr auto cell_idx(sz_t x, sz_t y) noexcept
             {
-                return cell_by_idxs(idx(p.x), idx(p.y));
+                return (y + offset) * grid_width + (x + offset);
             }
 
-            // Executes `f` on every cell contaning the circle described by `p`
-            // and `r`.
-            template <typename TF>
-            void for_cells_of(const vec2f& p, float r, TF&& f)
+            // Returns the cell with linear index `i`.
+            auto cell_at(sz_t i) const noexcept
             {
-                auto left = p.x - r;
-                auto right = p.x + r;
-                auto top = p.y - r;
-                auto bottom = p.y + r;
+                const auto* base = _entities.data();
+                return cell_view{base + _offsets[i], base + _ends[i]};
+            }
 
-                auto s_ix = fFloor(idx(left));
-                auto e_ix = fCeil(idx(right));
-                auto s_iy = fFloor(idx(top));
-                auto e_iy = fCeil(idx(bottom));
+            auto cell_by_idxs(sz_t x, sz_t y) const noexcept
+            {
+                return cell_at(cell_idx(x, y));
+            }
 
-                for(auto ix(s_ix); ix <= e_ix; ++ix)
+            // Registers a subtask output that has to be scattered.
+            void enqueue_sp(sp_output& o)
+            {
+                _pending.emplace_back(&o);
+            }
+
+            // Returns the cell following the last one of scan block `k`.
+            static constexpr auto scan_block_end(sz_t k) noexcept
+            {
+                return (k + 1) * scan_block_cells < cell_count
+                           ? (k + 1) * scan_block_cells
+                           : cell_count;
+            }
+
+            // Returns the number of entries of the pending outputs in the
+            // cells of scan block `k`.
+            auto scan_block_size(sz_t k) const noexcept
+            {
+                const auto last = scan_block_end(k);
+
+                sz_t n = 0;
+                for(auto i = k * scan_block_cells; i < last; ++i)
                 {
-                    for(auto iy(s_iy); iy <= e_iy; ++iy)
+                    for(auto* o : _pending) n += o->_cells[i];
+                }
+
+                return n;
+            }
+
+            // Scans the cells of scan block `k`, starting from its first
+            // slot. Returns the slot following its last entry.
+            auto scan_block(sz_t k) noexcept
+            {
+                auto acc = _block_offsets[k];
+                const auto last = scan_block_end(k);
+
+                for(auto i = k * scan_block_cells; i < last; ++i)
+                {
+                    _offsets[i] = acc;
+                    for(auto* o : _pending)
                     {
-                        f(ix, iy);
+                        auto n = o->_cells[i];
+                        o->_cells[i] = acc;
+                        acc += n;
                     }
+
+                    _ends[i] = acc;
                 }
+
+                return acc;
             }
 
-            template <typename TData>
-            void process(TData& data)
+            // Computes the cell offsets and turns the per-cell counts of
+            // every pending output into write cursors. Entries of the same
+            // cell are laid out in subtask order, so that the resulting grid
+            // does not depend on which filler subtask scatters which output.
+            // The cells are scanned in blocks on the work-stealing pool: the
+            // size of every block is computed in parallel, a serial scan of
+            // the sizes gives the first slot of every block, then every
+            // block scans its own cells in parallel. This reads the counts
+            // twice: with a single thread, the blocks are scanned in order
+            // in a single pass instead.
+            void prefix_sum()
             {
-                // Get a reference to the output vector and clear it.
-                auto& o = data.output();
-                o.clear();
+                auto& pool = default_work_stealing_pool();
 
-                // For every entity in the subtask...
-                data.for_entities([&](auto eid)
+                if(pool.thread_count() == 1)
+                {
+                    for(sz_t k = 0; k < scan_block_count; ++k)
                     {
-                        // Access component data.
-                        const auto& p = data.get(ct::position, eid)._v;
-                        const auto& c = data.get(ct::circle, eid)._radius;
-
-                        // Figure out the broadphase cell and emplace an
-                        // `sp_data` instance in the output vector.
-                        this->for_cells_of(p, c, [eid, &o](auto cx, auto cy)
+                        _block_offsets[k + 1] = scan_block(k);
+                    }
+                }
+                else
+                {
+                    pool.parallel_for(scan_block_count, 1,
+                        [this](sz_t b, sz_t e)
+                        {
+                            for(auto k = b; k < e; ++k)
                             {
-                                o.emplace_back(eid, cx, cy);
-                            });
-                    });
+                                _block_offsets[k + 1] =
+                                    this->scan_block_size(k);
+                            }
+                        });
+
+                    for(sz_t k = 0; k < scan_block_count; ++k)
+                    {
+                        _block_offsets[k + 1] += _block_offsets[k];
+                    }
+
+                    pool.parallel_for(scan_block_count, 1,
+                        [this](sz_t b, sz_t e)
+                        {
+                            for(auto k = b; k < e; ++k) this->scan_block(k);
+                        });
+                }
+
+                const auto acc = _block_offsets[scan_block_count];
+                _offsets[cell_count] = acc;
+                _entities.resize(acc);
+                _next_pending = 0;
+
+                // Every entity has a single slot: record it while scattering.
+                if(max_cells_per_entity == 1)
+                {
+                    sz_t id_end = 0;
+                    for(auto* o : _pending)
+                    {
+                        id_end = std::max(id_end, o->_id_end);
+                    }
+
+                    if(_slot_of.size() < id_end) _slot_of.resize(id_end, npos);
+                }
             }
-        };
 
-        // This single-threaded system fills the spatial partitioning data
-        // structure.
-        struct spatial_filler
-        {
-            template <typename TData>
-            void execute(TData& data)
+            // Claims pending outputs one at a time and writes their entity IDs
+            // in their slots. Every output owns disjoint slots, therefore
+            // multiple subtasks can scatter concurrently without locking.
+            void scatter_pending() noexcept
             {
-                data.for_previous_outputs(st::spatial_partition,
-                    [](auto& s, auto& sp_vector)
+                for(auto i = _next_pending++; i < _pending.size();
+                    i = _next_pending++)
+                {
+                    auto& o = *_pending[i];
+                    for(const auto& x : o._entries)
                     {
-                        for(const auto& x : sp_vector)
+                        const auto slot = o._cells[x._cell]++;
+                        _entities[slot] = x._e;
+
+                        if(max_cells_per_entity == 1)
                         {
-                            s.add_sp(x);
+                            _slot_of[static_cast<sz_t>(x._e)] = slot;
                         }
-                    });
+                    }
+                }
             }
-        };
 
-        // This system detects collisions between particles and produces an
-        // output vector of `contact` instances.
-        struct collision
-        {
-            template <typename TData>
-            void process(TData& data)
+            // Returns the entities following `eid` in cell `c`, the only
+            // cell it is assigned to with `bp_cell_pairs`.
+            auto cell_after(sz_t c, ecst::entity_id eid) const noexcept
             {
-                // Get a reference to the output vector and clear it.
-                auto& out = data.output();
-                out.clear();
-
-                // Get a reference to the `spatial_partition` system.
-                auto& sp = data.system(st::spatial_partition);
-
-                // For every entity in the subtask...
-                data.for_entities([&](auto eid)
-                    {
-                        // Access the component data.
-                        auto& p0 = data.get(ct::position, eid)._v;
-                        const auto& r0 = data.get(ct::circle, eid)._radius;
+                assert(max_cells_per_entity == 1);
 
-                        // Access the grid cell containing position `p0`.
-                        auto& cell = sp.cell_by_pos(p0);
+                const auto* base = _entities.data();
+                const auto slot = _slot_of[static_cast<sz_t>(eid)];
+                assert(_offsets[c] <= slot && slot < _ends[c]);
+                assert(base[slot] == eid);
 
-                        // For every unique entity ID pair...
-                        for_unique_pairs(cell, eid, [&](auto eid2)
-                            {
-                                // Access the second particle's component data.
-                                auto& p1 = data.get(ct::position, eid2)._v;
-                                const auto& r1 =
-                                    data.get(ct::circle, eid2)._radius;
-
-                                // Check for a circle-circle collision.
-                                auto sd = squared_distance(p0, p1);
-                                if(sd <= square(r0 + r1))
-                                {
-                                    // Emplace a `contact` in the output.
-                                    out.emplace_back(eid, eid2, std::sqrt(sd));
-                                }
-                            });
-                    });
+                return cell_view{base + slot + 1, base + _ends[c]};
             }
-        };
 
-        // This single-threaded system solves contacts by preventing penetration
-        // between particles and by modifying their velocities to simulate
-        // bouncing.
-        struct solve_contacts
-        {
-            template <typename TData>
-            void process(TData& data)
+            // Returns the first entity of the grid, in cell order, or
+            // `nullptr` if the grid is empty.
+            auto first_entity() const noexcept
             {
-                // For every output produced by the collision detection
-                // system...
-                data.for_previous_outputs(st::collision,
-                    [&](auto&, const auto& out)
+                const ecst::entity_id* result = nullptr;
+                for(sz_t i = 0; i < cell_count && result == nullptr; ++i)
+                {
+                    if(_ends[i] != _offsets[i])
                     {
-                        for(const auto& x : out)
-                        {
-                            // Access the f-Dirst particle's data.
-                            auto& p0 = data.get(ct::position, x._e0)._v;
-                            auto& v0 = data.get(ct::velocity, x._e0)._v;
-                            const auto& r0 =
-                                data.get(ct::circle, x._e0)._radius;
-
-                            // Access the second particle's data.
-                            auto& p1 = data.get(ct::position, x._e1)._v;
-                            auto& v1 = data.get(ct::velocity, x._e1)._v;
-                            const auto& r1 =
-                                data.get(ct::circle, x._e1)._radius;
+                        result = _entities.data() + _offsets[i];
+                    }
+                }
 
-                            // Solve.
-                            solve_penetration(x, p0, v0, r0, p1, v1, r1);
-                        }
-                    });
+                return result;
             }
-        };
 
-        // This system builds a vector of vertices for every subtask.
-        // The vertices will then be rendered in a later step.
-        struct render_colored_circle
-        {
-            static constexpr float tau = 6.28f;
-            static constexpr sz_t precision = 5;
-            static constexpr float inc = tau / precision;
+            // Returns the cell of `eid` in the previous frame, or `npos`.
+            auto previous_cell(ecst::entity_id eid) const noexcept
+            {
+                const auto i = static_cast<sz_t>(eid);
+                return i < _cell_of.size() ? _cell_of[i] : npos;
+            }
 
-            template <typename TData>
-            void process(TData& data)
+            // Removes `eid` from its cell, filling its slot with the last
+            // entity of the cell.
+            void remove_from_cell(ecst::entity_id eid) noexcept
             {
-                // Get a reference to the output vector, and clear it.
-                auto& va = data.output();
-                va.clear();
+                const auto i = static_cast<sz_t>(eid);
+                const auto slot = _slot_of[i];
+                const auto moved = _entities[--_ends[_cell_of[i]]];
 
-                // For every entity in the subtask...
-                data.for_entities([this, &data, &va](auto eid)
-                    {
-                        // Access the component data.
-                        const auto& p0 = data.get(ct::position, eid)._v;
-                        const auto& c = data.get(ct::color, eid)._v;
-                        auto& radius = data.get(ct::circle, eid)._radius;
+                _entities[slot] = moved;
+                _slot_of[static_cast<sz_t>(moved)] = slot;
+                _cell_of[i] = npos;
+            }
 
-                        // Function to create and emplace 3 vertices.
-                        auto mk_triangle = [&va, &data, &p0, &c, &radius](
-                            auto a0, auto a1)
-                        {
-                            auto a0cos = radius * tbl_cos(a0);
-                            auto a0sin = radius * tbl_sin(a0);
-                            auto a1cos = radius * tbl_cos(a1);
-                            auto a1sin = radius * tbl_sin(a1);
+            // Appends `eid` to cell `c`, or marks it as overflowed if the
+            // cell has no free slots.
+            void insert_in_cell(ecst::entity_id eid, sz_t c)
+            {
+                const auto i = static_cast<sz_t>(eid);
+                _cell_of[i] = c;
 
-                            vec2f p1(a0cos + p0.x, a0sin + p0.y);
-                            vec2f p2(a1cos + p0.x, a1sin + p0.y);
+                if(_ends[c] == _offsets[c + 1])
+                {
+                    _overflowed.emplace_back(eid);
+                    return;
+                }
 
-                            va.emplace_back(p0, c);
-                            va.emplace_back(p1, c);
-                            va.emplace_back(p2, c);
-                        };
+                _slot_of[i] = _ends[c];
+                _entities[_ends[c]++] = eid;
+            }
 
-                        // Build a circle.
-                        for(sz_t i = 0; i < precision; ++i)
-                        {
-                            mk_triangle(inc * i, inc * (i + 1));
-                        }
-                    });
+            // Removes `eid` from the grid. Has to be called when an entity
+            // tracked by `grid::g_incremental` is destroyed.
+            void remove_entity(ecst::entity_id eid) noexcept
+            {
+                if(previous_cell(eid) != npos) remove_from_cell(eid);
             }
-        };
-    }
 
-    // Compile-time `std::size_t` entity limit.
-    constexpr auto entity_limit = ecst::sz_v<50000>;
+            // Renames the entities of the grid after they have been
+            // reordered: `new_of[i]` is the new ID of the entity `i`, for
+            // every live entity. Removed entities are not in the grid.
+            void remap_entities(const std::vector<ecst::entity_id>& new_of)
+            {
+                auto remap = [&new_of](auto eid)
+                {
+                    return new_of[static_cast<sz_t>(eid)];
+                };
 
-    // Compile-time initial particle count.
-    constexpr auto initial_particle_count = ecst::sz_v<20000>;
+                for(sz_t i = 0; i < cell_count; ++i)
+                {
+                    std::transform(_entities.begin() + _offsets[i],
+                        _entities.begin() + _ends[i],
+                        _entities.begin() + _offsets[i], remap);
+                }
 
-    namespace ecst_setup
+                // Entities created in the current step are not in the grid
+                // yet, and can have IDs past the end of the per-entity state.
+                // IDs past `new_of.size()` belong to removed entities, which
+                // are not renamed.
+                auto permute = [&new_of](auto& v)
+                {
+                    if(v.size() < new_of.size()) v.resize(new_of.size(), npos);
+
+                    auto result = v;
+                    for(sz_t i = 0; i < new_of.size(); ++i)
+                    {
+                        result[static_cast<sz_t>(new_of[i])] = v[i];
+                    }
+
+                    v = std::move(result);
+                };
+
+                permute(_cell_of);
+                permute(_slot_of);
+
+                for(auto i = new_of.size(); i < _cell_of.size(); ++i)
+                {
+                    assert(_cell_of[i] == npos);
+                }
+            }
+
+            // Lays out the grid again, including the overflowed entities,
+            // leaving free slots in every cell for the following frames.
+            void relayout()
+            {
+                // Turn the number of entities of every cell into offsets.
+                _relayout_offsets.assign(cell_count + 1, 0);
+                for(sz_t i = 0; i < cell_count; ++i)
+                {
+                    _relayout_offsets[i + 1] = _ends[i] - _offsets[i];
+                }
+
+                for(auto eid : _overflowed)
+                {
+                    ++_relayout_offsets[_cell_of[static_cast<sz_t>(eid)] + 1];
+                }
+
+                sz_t acc = 0;
+                for(sz_t i = 0; i < cell_count; ++i)
+                {
+                    const auto n = _relayout_offsets[i + 1];
+                    _relayout_offsets[i] = acc;
+                    acc += n + n / 4 + min_free_slots;
+                }
+
+                _relayout_offsets[cell_count] = acc;
+                _relayout_entities.resize(acc);
+
+                // Move the entities of every cell to their new slots.
+                for(sz_t i = 0; i < cell_count; ++i)
+                {
+                    auto slot = _relayout_offsets[i];
+                    for(auto eid : cell_at(i))
+                    {
+                        _relayout_entities[slot] = eid;
+                        _slot_of[static_cast<sz_t>(eid)] = slot++;
+                    }
+
+                    _ends[i] = slot;
+                }
+
+                std::swap(_entities, _relayout_entities);
+                std::copy(_relayout_offsets.begin(), _relayout_offsets.end(),
+                    _offsets.begin());
+
+                // Every cell now has enough free slots for its overflowed
+                // entities.
+                for(auto eid : _overflowed)
+                {
+                    const auto i = static_cast<sz_t>(eid);
+                    const auto c = _cell_of[i];
+
+                    _slot_of[i] = _ends[c];
+                    _entities[_ends[c]++] = eid;
+                }
+
+                _overflowed.clear();
+            }
+
+            // Moves the entities of every pending output to their new cell,
+            // in subtask order.
+            void apply_pending()
+            {
+                for(auto* o : _pending)
+                {
+                    for(const auto& x : o->_entries)
+                    {
+                        const auto i = static_cast<sz_t>(x._e);
+                        if(i >= _cell_of.size())
+                        {
+                            _cell_of.resize(i + 1, npos);
+                            _slot_of.resize(i + 1, npos);
+                        }
+
+                        remove_entity(x._e);
+                        insert_in_cell(x._e, x._cell);
+                    }
+                }
+
+                if(!_overflowed.empty()) relayout();
+            }
+
+            // Prepares the pending outputs to be written in the grid.
+            void prepare_pending(grid::g_rebuild)
+            {
+                prefix_sum();
+            }
+
+            void prepare_pending(grid::g_incremental) noexcept
+            {
+            }
+
+            // Writes the pending outputs in the grid.
+            void write_pending(grid::g_rebuild) noexcept
+            {
+                scatter_pending();
+            }
+
+            void write_pending(grid::g_incremental)
+            {
+                apply_pending();
+            }
+
+            // From world coordinates to cell index.
+            auto idx(float x) const noexcept
+            {
+                return x / cell_size;
+            }
+
+            // Returns the cell containing the position `p`.
+            auto cell_by_pos(const vec2f& p) const noexcept
+            {
+                return cell_by_idxs(idx(p.x), idx(p.y));
+            }
+
+            // Executes `f` on every cell contaning the circle described by `p`
+            // and `r`.
+            template <typename TF>
+            void for_cells_of(const vec2f& p, float r, TF&& f)
+            {
+                auto left = p.x - r;
+                auto right = p.x + r;
+                auto top = p.y - r;
+                auto bottom = p.y + r;
+
+                auto s_ix = fFloor(idx(left));
+                auto e_ix = fCeil(idx(right));
+                auto s_iy = fFloor(idx(top));
+                auto e_iy = fCeil(idx(bottom));
+
+                for(auto iy(s_iy); iy <= e_iy; ++iy)
+                {
+                    for(auto ix(s_ix); ix <= e_ix; ++ix)
+                    {
+                        f(ix, iy);
+                    }
+                }
+            }
+
+            // Executes `f` on every cell the circle described by `p` and `r`
+            // is assigned to, depending on the broadphase strategy.
+            template <typename TF>
+            void for_assigned_cells(broadphase::bp_overlapped_cells,
+                const vec2f& p, float r, TF&& f)
+            {
+                for_cells_of(p, r, f);
+            }
+
+            template <typename TF>
+            void for_assigned_cells(
+                broadphase::bp_cell_pairs, const vec2f& p, float, TF&& f)
+            {
+                f(static_cast<sz_t>(idx(p.x)), static_cast<sz_t>(idx(p.y)));
+            }
+
+            // Emits an `sp_data` for every entity of the subtask that
+            // changed cell since the previous frame.
+            template <typename TData>
+            void process(grid::g_incremental, TData& data, sp_output& o)
+            {
+                o._entries = _arena.acquire(data.entity_count());
+                o._cells.clear();
+
+                for_entities_with(data, ct::position)(
+                    [&](auto eid, const auto& c_position)
+                    {
+                        const auto& p = c_position._v;
+                        const auto i = cell_idx(static_cast<sz_t>(idx(p.x)),
+                            static_cast<sz_t>(idx(p.y)));
+
+                        if(this->previous_cell(eid) != i)
+                        {
+                            o._entries.emplace_back(eid, i);
+                        }
+                    });
+            }
+
+            template <typename TData>
+            void process(grid::g_rebuild, TData& data, sp_output& o)
+            {
+                // Assign the output a segment of the arena, large enough for
+                // the worst case.
+                o._entries =
+                    _arena.acquire(data.entity_count() * max_cells_per_entity);
+                o._cells.assign(cell_count, 0);
+                o._id_end = 0;
+
+                // For every entity in the subtask, with its component
+                // data...
+                for_entities_with(data, ct::position, ct::circle)(
+                    [&](auto eid, const auto& c_position, const auto& c_circle)
+                    {
+                        const auto& p = c_position._v;
+                        const auto& c = c_circle._radius;
+
+                        o._id_end =
+                            std::max(o._id_end, static_cast<sz_t>(eid) + 1);
+
+                        // Figure out the broadphase cell, emplace an
+                        // `sp_data` instance in the output vector and count
+                        // it in its cell.
+                        this->for_assigned_cells(collision_broadphase{}, p, c,
+                            [eid, &o](auto cx, auto cy)
+                            {
+                                auto i = cell_idx(cx, cy);
+                                o._entries.emplace_back(eid, i);
+                                ++o._cells[i];
+                            });
+                    });
+            }
+
+            template <typename TData>
+            void process(TData& data)
+            {
+                // Get a reference to the output.
+                auto& o = data.output();
+                process(grid_update{}, data, o);
+            }
+        };
+
+        constexpr decltype(spatial_partition::npos) spatial_partition::npos;
+
+        // This single-threaded system computes where every subtask output of
+        // `spatial_partition` will be written in the grid.
+        struct spatial_offsets
+        {
+            template <typename TData>
+            void execute(TData& data)
+            {
+                auto& sp = data.system(st::spatial_partition);
+                sp._pending.clear();
+
+                // Gather the outputs of every subtask.
+                data.for_previous_outputs(st::spatial_partition,
+                    [](auto& s, auto& o)
+                    {
+                        s.enqueue_sp(o);
+                    });
+
+                // Compute the cell offsets and the write cursors.
+                sp.prepare_pending(grid_update{});
+            }
+        };
+
+        // This system fills the spatial partitioning data structure. Its
+        // subtasks scatter the outputs of `spatial_partition` in parallel.
+        // With `grid::g_incremental`, its only subtask moves the entities
+        // that changed cell.
+        struct spatial_filler
+        {
+            template <typename TData>
+            void execute(TData& data)
+            {
+                data.system(st::spatial_partition)
+                    .write_pending(grid_update{});
+            }
+        };
+
+        // This system detects collisions between particles and produces
+        // segments of `contact` instances (see `contact_output`).
+        struct collision
+        {
+            // Number of entities processed by a work-stealing block, and its
+            // tuner (see `collision_grain`).
+            grain_tuner _grain{
+                make_grain_tuner(collision_grain{}, 256, 32, 4096)};
+
+            // Number of grid rows processed by a work-stealing block, with
+            // `broadphase::bp_cell_pairs`, and its tuner.
+            grain_tuner _row_grain{
+                make_grain_tuner(collision_grain{}, 4, 1, 64)};
+
+            // Entities of the system, used with `sched::s_work_stealing`.
+            std::vector<ecst::entity_id> _entities;
+
+            // Checks for a circle-circle collision between `eid` and `eid2`,
+            // emplacing a `contact` in `out` if they overlap.
+            template <typename TData, typename TOut>
+            void test_pair(TData& data, ecst::entity_id eid, const vec2f& p0,
+                float r0, ecst::entity_id eid2, TOut& out)
+            {
+                // Access the second particle's component data.
+                auto& p1 = data.get(ct::position, eid2)._v;
+                const auto& r1 = data.get(ct::circle, eid2)._radius;
+
+                // Check for a circle-circle collision.
+                auto sd = squared_distance(p0, p1);
+                if(sd <= square(r0 + r1))
+                {
+                    // Emplace a `contact` in the output.
+                    out.emplace_back(eid, eid2, std::sqrt(sd));
+                }
+            }
+
+            // Executes `f` on the linear index of every neighbor in the
+            // half-neighborhood of the cell with grid coordinates `(x, y)`:
+            // right, bottom-left, bottom and bottom-right. Every pair of
+            // adjacent cells is visited exactly once from one of the two.
+            template <typename TSP, typename TF>
+            static void for_half_neighbors(sz_t x, sz_t y, TF&& f)
+            {
+                constexpr auto w = TSP::grid_width;
+                constexpr auto h = TSP::grid_height;
+                const auto i = y * w + x;
+
+                if(x + 1 < w) f(i + 1);
+                if(y + 1 >= h) return;
+
+                if(x > 0) f(i + w - 1);
+                f(i + w);
+                if(x + 1 < w) f(i + w + 1);
+            }
+
+            // Detects the collisions of `eid`, emplacing them in `out`.
+            template <typename TData, typename TSP, typename TOut>
+            void detect(broadphase::bp_overlapped_cells, TData& data,
+                const TSP& sp, ecst::entity_id eid, TOut& out)
+            {
+                // Access the component data.
+                auto& p0 = data.get(ct::position, eid)._v;
+                const auto& r0 = data.get(ct::circle, eid)._radius;
+
+                // Access the grid cell containing position `p0`.
+                auto cell = sp.cell_by_pos(p0);
+
+                // For every unique entity ID pair...
+                for_unique_pairs(cell, eid, [&](auto eid2)
+                    {
+                        this->test_pair(data, eid, p0, r0, eid2, out);
+                    });
+            }
+
+            // Detects the collisions of `eid` with the particles following
+            // it in its own cell and with the ones in the half-neighborhood
+            // of the cell, emplacing them in `out`.
+            template <typename TData, typename TSP, typename TOut>
+            void detect(broadphase::bp_cell_pairs, TData& data,
+                const TSP& sp, ecst::entity_id eid, TOut& out)
+            {
+                auto& p0 = data.get(ct::position, eid)._v;
+                const auto& r0 = data.get(ct::circle, eid)._radius;
+
+                const auto x = static_cast<sz_t>(sp.idx(p0.x)) + TSP::offset;
+                const auto y = static_cast<sz_t>(sp.idx(p0.y)) + TSP::offset;
+
+                for(auto eid2 : sp.cell_after(y * TSP::grid_width + x, eid))
+                {
+                    test_pair(data, eid, p0, r0, eid2, out);
+                }
+
+                for_half_neighbors<TSP>(x, y, [&](auto i)
+                    {
+                        for(auto eid2 : sp.cell_at(i))
+                        {
+                            this->test_pair(data, eid, p0, r0, eid2, out);
+                        }
+                    });
+            }
+
+            // Tests every pair of particles of the cell with grid
+            // coordinates `(x, y)`, and every pair between it and its
+            // half-neighborhood, emplacing contacts in `out`.
+            template <typename TData, typename TSP, typename TOut>
+            void detect_cell(
+                TData& data, const TSP& sp, sz_t x, sz_t y, TOut& out)
+            {
+                auto cell = sp.cell_at(y * TSP::grid_width + x);
+                if(cell.size() == 0) return;
+
+                for(auto it = cell.begin(); it != cell.end(); ++it)
+                {
+                    const auto eid = *it;
+                    auto& p0 = data.get(ct::position, eid)._v;
+                    const auto& r0 = data.get(ct::circle, eid)._radius;
+
+                    for(auto it2 = it + 1; it2 != cell.end(); ++it2)
+                    {
+                        test_pair(data, eid, p0, r0, *it2, out);
+                    }
+                }
+
+                for_half_neighbors<TSP>(x, y, [&](auto i)
+                    {
+                        auto other = sp.cell_at(i);
+
+                        for(auto eid : cell)
+                        {
+                            auto& p0 = data.get(ct::position, eid)._v;
+                            const auto& r0 =
+                                data.get(ct::circle, eid)._radius;
+
+                            for(auto eid2 : other)
+                            {
+                                this->test_pair(
+                                    data, eid, p0, r0, eid2, out);
+                            }
+                        }
+                    });
+            }
+
+            // Every subtask processes its even share of the entities, in a
+            // single segment.
+            // Neighbors are arbitrary particles: the component storage is
+            // resolved once per chunk of entities, from its first one, and
+            // indexed by entity ID by `detect`.
+            template <typename TBroadphase, typename TData, typename TSP>
+            void process_impl(sched::s_split_evenly, TBroadphase bp,
+                TData& data, const TSP& sp, contact_output& out)
+            {
+                out.reset(1);
+                auto& segment = out.segment(0);
+
+                for_entity_chunks(data, [&](auto& chunk)
+                    {
+                        const auto first = chunk.first();
+                        auto cached = cache_components(data,
+                            ecst::entity_id(first), ct::position, ct::circle);
+
+                        for(sz_t i = 0; i < chunk.size(); ++i)
+                        {
+                            this->detect(bp, cached, sp,
+                                ecst::entity_id(first + i), segment);
+                        }
+                    });
+            }
+
+            // The only subtask hands blocks of entities to the work-stealing
+            // pool. Every block writes its contacts to its own segment of the
+            // output, so that the output does not depend on which thread ran
+            // which block.
+            template <typename TData, typename TSP>
+            void process_impl(sched::s_work_stealing,
+                broadphase::bp_overlapped_cells bp, TData& data,
+                const TSP& sp, contact_output& out)
+            {
+                _entities.clear();
+                data.for_entities([this](auto eid)
+                    {
+                        _entities.emplace_back(eid);
+                    });
+
+                const auto n = _entities.size();
+                const auto grain = _grain.grain();
+                out.reset((n + grain - 1) / grain);
+
+                if(n == 0) return;
+
+                auto cached = cache_components(
+                    data, _entities[0], ct::position, ct::circle);
+
+                _grain.parallel_for(default_work_stealing_pool(), n,
+                    [this, bp, grain, &cached, &sp, &out](sz_t b, sz_t e)
+                    {
+                        EXAMPLE_PROFILE_SCOPE("collision_block");
+
+                        auto& block = out.segment(b / grain);
+
+                        for(auto i = b; i < e; ++i)
+                        {
+                            this->detect(bp, cached, sp, _entities[i], block);
+                        }
+                    });
+            }
+
+            // The only subtask hands blocks of grid rows to the
+            // work-stealing pool, and every block walks its cells in order.
+            // Every block has its own segment, as above.
+            template <typename TData, typename TSP>
+            void process_impl(sched::s_work_stealing,
+                broadphase::bp_cell_pairs, TData& data, const TSP& sp,
+                contact_output& out)
+            {
+                constexpr auto h = TSP::grid_height;
+                const auto row_grain = _row_grain.grain();
+                out.reset((h + row_grain - 1) / row_grain);
+
+                const auto* anchor = sp.first_entity();
+                if(anchor == nullptr) return;
+
+                auto cached = cache_components(
+                    data, *anchor, ct::position, ct::circle);
+
+                _row_grain.parallel_for(default_work_stealing_pool(), h,
+                    [this, row_grain, &cached, &sp, &out](sz_t b, sz_t e)
+                    {
+                        EXAMPLE_PROFILE_SCOPE("collision_block");
+
+                        auto& block = out.segment(b / row_grain);
+
+                        for(auto y = b; y < e; ++y)
+                        {
+                            for(sz_t x = 0; x < TSP::grid_width; ++x)
+                            {
+                                this->detect_cell(cached, sp, x, y, block);
+                            }
+                        }
+                    });
+            }
+
+            template <typename TData>
+            void process(TData& data)
+            {
+                // Get a reference to the output. Its segments are reset by
+                // `process_impl`.
+                auto& out = data.output();
+
+                // Get a reference to the `spatial_partition` system.
+                const auto& sp = data.system(st::spatial_partition);
+
+                process_impl(collision_scheduler{}, collision_broadphase{},
+                    data, sp, out);
+            }
+        };
+
+        // This single-threaded system partitions the contacts produced by
+        // `collision` in islands: connected components of the graph having
+        // particles as nodes and contacts as edges. Different islands never
+        // touch the same particle, so they can be solved concurrently.
+        struct contact_islands
+        {
+            static constexpr auto npos = std::numeric_limits<sz_t>::max();
+
+            // Number of islands claimed at once by a solver subtask.
+            static constexpr sz_t grain = 32;
+
+            // Union-find forest and island labels, indexed by entity ID.
+            // Only the entries listed in `_touched` are valid.
+            std::vector<sz_t> _parent;
+            std::vector<sz_t> _label;
+            std::vector<sz_t> _touched;
+
+            // Contacts of all the "Collision" subtasks, in output order,
+            // and, with `contact_order::o_sorted`, sorted by entity IDs.
+            segmented_view<contact> _view;
+            std::vector<contact> _contacts;
+
+            // Island of every contact, in gathering order.
+            std::vector<sz_t> _island_of;
+
+            // Contacts sorted by island, and island offsets into them.
+            std::vector<contact> _sorted;
+            std::vector<sz_t> _offsets;
+
+            // Index of the next island to be claimed by a solver subtask.
+            std::atomic<sz_t> _next_island{0};
+
+            void touch(sz_t x)
+            {
+                if(x >= _parent.size())
+                {
+                    _parent.resize(x + 1, npos);
+                    _label.resize(x + 1, npos);
+                }
+
+                if(_parent[x] == npos)
+                {
+                    _parent[x] = x;
+                    _touched.emplace_back(x);
+                }
+            }
+
+            auto find(sz_t x) noexcept
+            {
+                while(_parent[x] != x)
+                {
+                    _parent[x] = _parent[_parent[x]];
+                    x = _parent[x];
+                }
+
+                return x;
+            }
+
+            // The smallest root always becomes the representative, keeping
+            // the forest independent from the order of the unions.
+            void unite(sz_t a, sz_t b) noexcept
+            {
+                a = find(a);
+                b = find(b);
+
+                if(a == b) return;
+                if(a > b) std::swap(a, b);
+
+                _parent[b] = a;
+            }
+
+            void clear() noexcept
+            {
+                for(auto x : _touched)
+                {
+                    _parent[x] = npos;
+                    _label[x] = npos;
+                }
+
+                _touched.clear();
+                _view.clear();
+                _contacts.clear();
+                _island_of.clear();
+                _offsets.clear();
+            }
+
+            // Executes `f(i, contact)` on every gathered contact, in
+            // gathering order...
+            template <typename TF>
+            void for_gathered(contact_order::o_output, TF&& f) const
+            {
+                sz_t i = 0;
+                for(const auto& x : _view) f(i++, x);
+            }
+
+            // ...which, for sorted contacts, is the order of the buffer.
+            template <typename TF>
+            void for_gathered(contact_order::o_sorted, TF&& f) const
+            {
+                for(sz_t i = 0; i < _contacts.size(); ++i) f(i, _contacts[i]);
+            }
+
+            void gather(contact_order::o_output) noexcept
+            {
+            }
+
+            void gather(contact_order::o_sorted)
+            {
+                EXAMPLE_PROFILE_SCOPE("sort_contacts");
+
+                _view.sort_into(default_work_stealing_pool(), _contacts,
+                    [](const auto& a, const auto& b)
+                    {
+                        return std::tie(a._e0, a._e1) <
+                               std::tie(b._e0, b._e1);
+                    });
+            }
+
+            template <typename TF>
+            void for_gathered(TF&& f) const
+            {
+                for_gathered(contact_gathering{}, f);
+            }
+
+            template <typename TData>
+            void execute(TData& data)
+            {
+                clear();
+
+                // View the contacts of every subtask, in subtask order,
+                // without copying them.
+                data.for_previous_outputs(st::collision,
+                    [this](auto&, const auto& out)
+                    {
+                        _view.add(out);
+                    });
+
+                gather(contact_gathering{});
+
+                // Join the particles connected by every contact.
+                for_gathered([this](auto, const auto& x)
+                    {
+                        auto e0 = static_cast<sz_t>(x._e0);
+                        auto e1 = static_cast<sz_t>(x._e1);
+
+                        this->touch(e0);
+                        this->touch(e1);
+                        this->unite(e0, e1);
+                    });
+
+                // Label the islands in order of first appearance and count
+                // their contacts. `_offsets[i + 1]` temporarily holds the
+                // count of island `i`.
+                _offsets.emplace_back(0);
+                for_gathered([this](auto, const auto& x)
+                    {
+                        auto& l = _label[this->find(static_cast<sz_t>(x._e0))];
+                        if(l == npos)
+                        {
+                            l = _offsets.size() - 1;
+                            _offsets.emplace_back(0);
+                        }
+
+                        _island_of.emplace_back(l);
+                        ++_offsets[l + 1];
+                    });
+
+                // Stable counting sort of the contacts by island: contacts of
+                // the same island keep their relative order, which makes the
+                // parallel solution identical to a sequential one.
+                for(sz_t i = 1; i < _offsets.size(); ++i)
+                {
+                    _offsets[i] += _offsets[i - 1];
+                }
+
+                _sorted.resize(_island_of.size());
+                auto cursors = _offsets;
+                for_gathered([this, &cursors](auto i, const auto& x)
+                    {
+                        _sorted[cursors[_island_of[i]]++] = x;
+                    });
+
+                _next_island = 0;
+            }
+
+            auto island_count() const noexcept
+            {
+                return _offsets.size() - 1;
+            }
+
+            // Claims islands `grain` at a time and executes `f` on all of
+            // their contacts, in order.
+            template <typename TF>
+            void for_claimed_contacts(TF&& f)
+            {
+                const auto n = island_count();
+                for(auto i = _next_island.fetch_add(grain); i < n;
+                    i = _next_island.fetch_add(grain))
+                {
+                    const auto i_end = std::min(i + grain, n);
+                    for(auto j = _offsets[i]; j < _offsets[i_end]; ++j)
+                    {
+                        f(_sorted[j]);
+                    }
+                }
+            }
+        };
+
+        constexpr decltype(contact_islands::npos) contact_islands::npos;
+
+        // This system solves contacts by preventing penetration between
+        // particles and by modifying their velocities to simulate bouncing.
+        // Its subtasks solve disjoint sets of islands in parallel.
+        struct solve_contacts
+        {
+            template <typename TData>
+            void process(TData& data)
+            {
+                auto& ci = data.system(st::contact_islands);
+
+                // Contacts refer to arbitrary particles: resolve the
+                // component storage once, from the particles of any contact,
+                // and index it by entity ID.
+                if(ci._sorted.empty()) return;
+
+                auto cached = cache_components(data, ci._sorted.front()._e0,
+                    ct::position, ct::velocity, ct::circle);
+
+                // For every contact of every claimed island...
+                ci.for_claimed_contacts([&](const auto& x)
+                    {
+                        // Access the first particle's data.
+                        auto& p0 = cached.get(ct::position, x._e0)._v;
+                        auto& v0 = cached.get(ct::velocity, x._e0)._v;
+                        const auto& r0 = cached.get(ct::circle, x._e0)._radius;
+
+                        // Access the second particle's data.
+                        auto& p1 = cached.get(ct::position, x._e1)._v;
+                        auto& v1 = cached.get(ct::velocity, x._e1)._v;
+                        const auto& r1 = cached.get(ct::circle, x._e1)._radius;
+
+                        // Solve.
+                        solve_penetration(x, p0, v0, r0, p1, v1, r1);
+                    });
+            }
+        };
+
+        // This system builds a vector of circle instances for every subtask.
+        // The instances will then be rendered in a later step.
+        struct render_colored_circle
+        {
+            static constexpr float tau = 6.28f;
+            static constexpr sz_t precision = 5;
+            static constexpr float inc = tau / precision;
+
+            // Triangle fan of a unit circle, computed at compile time.
+            static constexpr auto fan = circle_fan<precision>::make(inc);
+
+            // Storage for the instance outputs of the subtasks. Double
+            // buffered: the outputs of a frame stay valid while the next one
+            // is executing (see `update_ctx_pipelined`).
+            frame_arena<circle_instance> _arenas[2];
+            sz_t _current_arena{0};
+
+            auto& current_arena() noexcept
+            {
+                return _arenas[_current_arena];
+            }
+
+            // Switches to the other arena, recycling the segments it holds.
+            // Must not be called while subtasks are using the arenas.
+            void flip_arenas()
+            {
+                _current_arena = 1 - _current_arena;
+                current_arena().reset();
+            }
+
+            // Draws the instances of all subtasks at once.
+            circle_renderer<precision> _renderer{fan};
+
+            // Whether the current step is rendered, and where the instances
+            // are placed between the previous (`0`) and current (`1`)
+            // positions of the particles. Set before executing the systems.
+            bool _emit{true};
+            float _alpha{1.f};
+
+            template <typename TData>
+            void process(TData& data)
+            {
+                // Get a reference to the output.
+                auto& out = data.output();
+
+                // Steps that are not rendered only record the positions the
+                // next one can interpolate from.
+                if(!_emit)
+                {
+                    out = arena_segment<circle_instance>{};
+
+                    for_entities_with(
+                        data, ct::position, ct::previous_position)(
+                        [](auto, const auto& c_position, auto& c_previous)
+                        {
+                            c_previous._v = c_position._v;
+                        });
+
+                    return;
+                }
+
+                // Assign the output a segment of the arena large enough for
+                // all the instances.
+                out = current_arena().acquire(data.entity_count());
+
+                // For every entity in the subtask, with its component
+                // data...
+                const auto alpha = _alpha;
+                for_entities_with(data, ct::position, ct::previous_position,
+                    ct::color, ct::circle)(
+                    [alpha, &out](auto, const auto& c_position,
+                        auto& c_previous, const auto& c_color,
+                        const auto& c_circle)
+                    {
+                        const auto& c = c_color._v;
+                        const auto& radius = c_circle._radius;
+
+                        auto p = c_position._v;
+                        if(alpha != 1.f)
+                        {
+                            p = c_previous._v + (p - c_previous._v) * alpha;
+                        }
+
+                        c_previous._v = c_position._v;
+
+                        // Emplace a single instance.
+                        out.emplace_back(
+                            p.x, p.y, radius, c.r, c.g, c.b, c.a);
+                    });
+            }
+        };
+
+        constexpr decltype(render_colored_circle::fan)
+            render_colored_circle::fan;
+    }
+
+    // Compile-time `std::size_t` entity limit, with `storage::s_fixed`.
+    constexpr auto entity_limit = ecst::sz_v<50000>;
+
+    // Compile-time initial entity capacity, with
+    // `storage::s_dynamic`.
+    constexpr auto entity_storage_chunk = ecst::sz_v<4096>;
+
+    // Whether `n` particles fit in the entity storage.
+    constexpr bool fits_in_storage(sz_t n) noexcept
+    {
+        return std::is_same<entity_storage, storage::s_dynamic>{} ||
+               n <= entity_limit;
+    }
+
+    // Compile-time number of entities below which the cheap per-entity
+    // systems run in a single subtask: splitting them costs more than it
+    // saves.
+    constexpr auto split_threshold = ecst::sz_v<4096>;
+
+    // Compile-time initial particle count.
+    constexpr auto initial_particle_count = ecst::sz_v<20000>;
+
+    namespace ecst_setup
     {
         // Builds and returns a "component signature list".
         constexpr auto make_csl()
         {
-            namespace slc = ecst::signature_list::component;
+            namespace slc = ecst::signature_list::component;
+
+            return slc::v<                                 
+                c::position, c::velocity, c::acceleration, 
+                c::color, c::circle, c::previous_position  
+                >;
+        }
+
+        // Returns the inner parallelism strategy of a system scheduled with
+        // `sched::s_split_evenly`...
+        template <typename TPar, typename TNone>
+        constexpr auto strategy_for(sched::s_split_evenly, TPar par, TNone)
+        {
+            return par;
+        }
+
+        // ...or with `sched::s_work_stealing`, which runs as a single ECST
+        // task.
+        template <typename TPar, typename TNone>
+        constexpr auto strategy_for(sched::s_work_stealing, TPar, TNone none)
+        {
+            return none;
+        }
+
+        // Returns the inner parallelism strategy of the "Spatial filler"
+        // system: grid deltas are applied by a single task.
+        template <typename TPar, typename TNone>
+        constexpr auto strategy_for(grid::g_rebuild, TPar par, TNone)
+        {
+            return par;
+        }
+
+        template <typename TPar, typename TNone>
+        constexpr auto strategy_for(grid::g_incremental, TPar, TNone none)
+        {
+            return none;
+        }
+
+        // Systems of the "system signature list" and their dependencies,
+        // from which both `make_ssl()` and the dependency graph checked at
+        // compile time (see `./utils/system_graph.hpp`) are built.
+        namespace dag
+        {
+            template <typename... TSystems>
+            struct systems
+            {
+            };
+
+            using system_list = systems<s::integration, s::spatial_partition,
+                s::spatial_offsets, s::spatial_filler, s::collision,
+                s::contact_islands, s::solve_contacts,
+                s::render_colored_circle>;
+
+            constexpr sz_t system_count = 8;
+
+            // `dependencies<T>::type` lists the systems `T` depends on.
+            template <typename TSystem>
+            struct dependencies;
+
+            template <typename TSystem>
+            using dependencies_t = typename dependencies<TSystem>::type;
+
+            template <>
+            struct dependencies<s::integration>
+            {
+                using type = systems<>;
+            };
+
+            template <>
+            struct dependencies<s::spatial_partition>
+            {
+                using type = systems<s::integration>;
+            };
+
+            template <>
+            struct dependencies<s::spatial_offsets>
+            {
+                using type = systems<s::spatial_partition>;
+            };
+
+            template <>
+            struct dependencies<s::spatial_filler>
+            {
+                using type = systems<s::spatial_offsets>;
+            };
+
+            template <>
+            struct dependencies<s::collision>
+            {
+                using type = systems<s::spatial_filler>;
+            };
+
+            template <>
+            struct dependencies<s::contact_islands>
+            {
+                using type = systems<s::collision>;
+            };
+
+            template <>
+            struct dependencies<s::solve_contacts>
+            {
+                using type = systems<s::contact_islands>;
+            };
+
+            template <>
+            struct dependencies<s::render_colored_circle>
+            {
+                using type = systems<s::solve_contacts>;
+            };
+
+            // Returns the index of `TSystem` in `system_list`, or
+            // `system_count` if it is not listed.
+            template <typename TSystem, typename... TSystems>
+            constexpr sz_t index_of(systems<TSystems...>) noexcept
+            {
+                constexpr bool same[] = {std::is_same<TSystem, TSystems>{}...};
+
+                sz_t i = 0;
+                while(i < sizeof...(TSystems) && !same[i]) ++i;
+
+                return i;
+            }
+
+            template <typename TSystem>
+            constexpr auto id = index_of<TSystem>(system_list{});
+
+            template <typename... TSystems>
+            constexpr auto mask_of(systems<TSystems...>) noexcept
+            {
+                return graph::bits(id<TSystems>...);
+            }
+
+            // Shared resources: the components, followed by the system state
+            // and outputs accessed through `data.system(...)` and
+            // `data.for_previous_outputs(...)`.
+            enum resource : sz_t
+            {
+                position,
+                velocity,
+                acceleration,
+                color,
+                circle,
+                previous_position,
+                sp_grid,
+                sp_outputs,
+                contacts,
+                islands
+            };
+
+            constexpr const char* resource_names[] = {"position", "velocity",
+                "acceleration", "color", "circle", "previous_position",
+                "sp_grid", "sp_outputs", "contacts", "islands"};
+
+            template <typename TSystem>
+            struct tag
+            {
+            };
+
+            // Returns the name, the read resources and the mutated resources
+            // of a system. Its dependencies are filled in by `make_graph`.
+            constexpr auto node_of(tag<s::integration>) noexcept
+            {
+                return graph::node{"integration", 0,
+                    graph::bits(acceleration, circle),
+                    graph::bits(velocity, position)};
+            }
+
+            constexpr auto node_of(tag<s::spatial_partition>) noexcept
+            {
+                return graph::node{"spatial_partition", 0,
+                    graph::bits(position, circle, sp_grid),
+                    graph::bits(sp_outputs)};
+            }
+
+            constexpr auto node_of(tag<s::spatial_offsets>) noexcept
+            {
+                return graph::node{"spatial_offsets", 0, graph::bits(),
+                    graph::bits(sp_grid, sp_outputs)};
+            }
+
+            constexpr auto node_of(tag<s::spatial_filler>) noexcept
+            {
+                return graph::node{"spatial_filler", 0,
+                    graph::bits(sp_outputs), graph::bits(sp_grid)};
+            }
+
+            constexpr auto node_of(tag<s::collision>) noexcept
+            {
+                return graph::node{"collision", 0,
+                    graph::bits(circle, sp_grid),
+                    graph::bits(velocity, position, contacts)};
+            }
+
+            constexpr auto node_of(tag<s::contact_islands>) noexcept
+            {
+                return graph::node{"contact_islands", 0,
+                    graph::bits(contacts), graph::bits(islands)};
+            }
+
+            constexpr auto node_of(tag<s::solve_contacts>) noexcept
+            {
+                return graph::node{"solve_contacts", 0, graph::bits(circle),
+                    graph::bits(velocity, position, islands)};
+            }
+
+            constexpr auto node_of(tag<s::render_colored_circle>) noexcept
+            {
+                return graph::node{"render_colored_circle", 0,
+                    graph::bits(circle, position, color),
+                    graph::bits(previous_position)};
+            }
+
+            template <typename TSystem>
+            constexpr auto node_with_dependencies() noexcept
+            {
+                auto n = node_of(tag<TSystem>{});
+                n._deps = mask_of(dependencies_t<TSystem>{});
+                return n;
+            }
+
+            template <typename... TSystems>
+            constexpr auto make_graph(systems<TSystems...>) noexcept
+            {
+                static_assert(sizeof...(TSystems) == system_count, "");
+                return graph::make_system_graph(
+                    node_with_dependencies<TSystems>()...);
+            }
+
+            template <typename... TSystems>
+            constexpr auto depends_on(systems<TSystems...>)
+            {
+                return ecst::signature::system::depends_on<TSystems...>;
+            }
+
+            constexpr auto depends_on(systems<>)
+            {
+                return ecst::signature::system::no_dependencies;
+            }
+        }
+
+        // Returns the dependency list of the signature of `TSystem`, which
+        // has to be in `dag::system_list`.
+        template <typename TSystem>
+        constexpr auto dependencies_of()
+        {
+            static_assert(dag::id<TSystem> < dag::system_count,
+                "system missing from `dag::system_list`");
 
-            return slc::v<                                 
-                c::position, c::velocity, c::acceleration, 
-                c::color, c::circle                        
-                >;
+            return dag::depends_on(dag::dependencies_t<TSystem>{});
         }
 
         // Builds and returns a "system signature list".
@@ -542,244 +2074,621 @@ namespace example
             constexpr auto none = ips::none::v();
             constexpr auto par = ips::split_evenly_fn::v_cores();
 
-            // Acceleration system.
-            // * Multithreaded.
-            // * No dependencies.
-            constexpr auto ssig_acceleration =    
-                ss::make<s::acceleration>(        
-                    par,                          
-                    ss::no_dependencies,          
-                    ss::component_use(            
-                        ss::mutate<c::velocity>,  
-                        ss::read<c::acceleration> 
-                        ),                        
-                    ss::output::none              
-                    );
+            // Inner parallelism of the cheap per-entity systems.
+            constexpr auto cheap_par =
+                ipc::none_below_threshold::v(split_threshold, par);
 
-            // Velocity system.
-            // * Multithreaded.
-            constexpr auto ssig_velocity =           
-                ss::make<s::velocity>(               
-                    par,                             
-                    ss::depends_on<s::acceleration>, 
-                    ss::component_use(               
-                        ss::mutate<c::position>,     
-                        ss::read<c::velocity>        
-                        ),                           
-                    ss::output::none                 
-                    );
+            // Inner parallelism of the "Collision" system.
+            constexpr auto collision_par =
+                strategy_for(collision_scheduler{}, par, none);
 
+            constexpr auto filler_par =
+                strategy_for(grid_update{}, par, none);
 
-            // Keep in bounds system.
-            // * Multithreaded.
-            constexpr auto ssig_keep_in_bounds = 
-                ss::make<s::keep_in_bounds>(     
-                    par,                         
-                    ss::depends_on<s::velocity>, 
-                    ss::component_use(           
-                        ss::mutate<c::velocity>, 
-                        ss::mutate<c::position>, 
-                        ss::read<c::circle>      
-                        ),                       
-                    ss::output::none             
+            // Integration system (fused acceleration, velocity and keep in
+            // bounds systems).
+            // * Multithreaded, above `split_threshold` entities.
+            // * No dependencies.
+            constexpr auto ssig_integration =          
+                ss::make<s::integration>(              
+                    cheap_par,                         
+                    dependencies_of<s::integration>(), 
+                    ss::component_use(                 
+                        ss::mutate<c::velocity>,       
+                        ss::mutate<c::position>,       
+                        ss::read<c::acceleration>,     
+                        ss::read<c::circle>            
+                        ),                             
+                    ss::output::none                   
                     );
 
             // Spatial partition system.
-            // * Multithreaded.
-            // * Output: `std::vector<sp_data>`.
-            constexpr auto ssig_spatial_partition =        
-                ss::make<s::spatial_partition>(            
-                    par,                                   
-                    ss::depends_on<s::keep_in_bounds>,     
-                    ss::component_use(                     
-                        ss::read<c::position>,             
-                        ss::read<c::circle>                
-                        ),                                 
-                    ss::output::data<std::vector<sp_data>> 
+            // * Multithreaded, above `split_threshold` entities.
+            // * Output: `sp_output`.
+            constexpr auto ssig_spatial_partition =          
+                ss::make<s::spatial_partition>(              
+                    cheap_par,                               
+                    dependencies_of<s::spatial_partition>(), 
+                    ss::component_use(                       
+                        ss::read<c::position>,               
+                        ss::read<c::circle>                  
+                        ),                                   
+                    ss::output::data<sp_output>              
                     );
 
-            // Spatial partition spatial_filler system.
+            // Spatial partition offsets system.
             // * Singlethreaded.
+            constexpr auto ssig_spatial_offsets =          
+                ss::make<s::spatial_offsets>(              
+                    none,                                  
+                    dependencies_of<s::spatial_offsets>(), 
+                    ss::no_component_use,                  
+                    ss::output::none                       
+                    );
+
+            // Spatial partition filler system.
+            // * Multithreaded (see `grid_update`).
             constexpr auto ssig_spatial_filler =          
                 ss::make<s::spatial_filler>(              
-                    none,                                 
-                    ss::depends_on<s::spatial_partition>, 
+                    filler_par,                           
+                    dependencies_of<s::spatial_filler>(), 
                     ss::no_component_use,                 
                     ss::output::none                      
                     );
 
             // Collision detection system.
-            // * Multithreaded.
-            // * Output: `std::vector<contact>`.
-            constexpr auto ssig_collision =                
-                ss::make<s::collision>(                    
-                    par,                                   
-                    ss::depends_on<s::spatial_filler>,     
-                    ss::component_use(                     
-                        ss::mutate<c::velocity>,           
-                        ss::mutate<c::position>,           
-                        ss::read<c::circle>                
-                        ),                                 
-                    ss::output::data<std::vector<contact>> 
+            // * Multithreaded (see `collision_scheduler`).
+            // * Output: `contact_output`.
+            constexpr auto ssig_collision =          
+                ss::make<s::collision>(              
+                    collision_par,                   
+                    dependencies_of<s::collision>(), 
+                    ss::component_use(               
+                        ss::mutate<c::velocity>,     
+                        ss::mutate<c::position>,     
+                        ss::read<c::circle>          
+                        ),                           
+                    ss::output::data<contact_output> 
                     );
 
-            // Solve contacts system.
+            // Contact islands system.
             // * Singlethreaded.
-            constexpr auto ssig_solve_contacts =  
-                ss::make<s::solve_contacts>(      
-                    none,                         
-                    ss::depends_on<s::collision>, 
-                    ss::component_use(            
-                        ss::mutate<c::velocity>,  
-                        ss::mutate<c::position>,  
-                        ss::read<c::circle>       
-                        ),                        
-                    ss::output::none              
+            constexpr auto ssig_contact_islands =          
+                ss::make<s::contact_islands>(              
+                    none,                                  
+                    dependencies_of<s::contact_islands>(), 
+                    ss::no_component_use,                  
+                    ss::output::none                       
                     );
 
-            // Render colored circle system.
+            // Solve contacts system.
             // * Multithreaded.
-            // * Output: `std::vector<sf::Vertex>`.
-            constexpr auto ssig_render_colored_circle =       
-                ss::make<s::render_colored_circle>(           
-                    par,                                      
-                    ss::depends_on<s::solve_contacts>,        
-                    ss::component_use(                        
-                        ss::read<c::circle>,                  
-                        ss::read<c::position>,                
-                        ss::read<c::color>                    
-                        ),                                    
-                    ss::output::data<std::vector<sf::Vertex>> 
+            constexpr auto ssig_solve_contacts =          
+                ss::make<s::solve_contacts>(              
+                    par,                                  
+                    dependencies_of<s::solve_contacts>(), 
+                    ss::component_use(                    
+                        ss::mutate<c::velocity>,          
+                        ss::mutate<c::position>,          
+                        ss::read<c::circle>               
+                        ),                                
+                    ss::output::none                      
+                    );
+
+            // Render colored circle system.
+            // * Multithreaded, above `split_threshold` entities.
+            // * Output: `arena_segment<circle_instance>`.
+            constexpr auto ssig_render_colored_circle =              
+                ss::make<s::render_colored_circle>(                  
+                    cheap_par,                                       
+                    dependencies_of<s::render_colored_circle>(),     
+                    ss::component_use(                               
+                        ss::read<c::circle>,                         
+                        ss::read<c::position>,                       
+                        ss::read<c::color>,                          
+                        ss::mutate<c::previous_position>             
+                        ),                                           
+                    ss::output::data<arena_segment<circle_instance>> 
                     );
 
             // Build and return the "system signature list".
             return sls::make(              
-                ssig_acceleration,         
-                ssig_velocity,             
-                ssig_keep_in_bounds,       
+                ssig_integration,          
                 ssig_spatial_partition,    
+                ssig_spatial_offsets,      
                 ssig_spatial_filler,       
                 ssig_collision,            
+                ssig_contact_islands,      
                 ssig_solve_contacts,       
                 ssig_render_colored_circle 
                 );
         }
+
+        // Builds and returns the dependency graph of `make_ssl()`.
+        constexpr auto make_dependency_graph()
+        {
+            return dag::make_graph(dag::system_list{});
+        }
+
+        constexpr auto dependency_graph = make_dependency_graph();
+
+        // Every pair of systems accessing the same resource, with at least
+        // one of them mutating it, must be ordered by the dependencies.
+        static_assert(dependency_graph.acyclic(), "");
+        static_assert(dependency_graph.unordered_conflicts() == 0,
+            "unordered systems access the same resource");
+
+        // Returns the entity storage settings of `storage::s_fixed`...
+        constexpr auto entity_storage_for(storage::s_fixed)
+        {
+            return ecst::settings::fixed<entity_limit>;
+        }
+
+        // ...or of `storage::s_dynamic`.
+        constexpr auto entity_storage_for(storage::s_dynamic)
+        {
+            return ecst::settings::dynamic<entity_storage_chunk>;
+        }
+
+        // Builds and returns the ECST context settings.
+        constexpr auto make_settings()
+        {
+            namespace cs = ecst::settings;
+            namespace ss = ecst::scheduler;
+
+            // (Systems with uneven per-entity cost can additionally be
+            // scheduled on a work-stealing pool: see
+            // `example::collision_scheduler`.)
+            return cs::make(                                    
+                cs::multithreaded(cs::allow_inner_parallelism), 
+                entity_storage_for(entity_storage{}),           
+                make_csl(),                                     
+                make_ssl(),                                     
+                cs::scheduler<ss::s_atomic_counter>             
+                );
+        }
+    }
+
+    // Initial state of a particle.
+    struct particle_init
+    {
+        vec2f _position;
+        float _radius;
+        vec2f _velocity;
+        sfc _color;
+    };
+
+    // Returns the initial state of a particle with random position, radius,
+    // velocity and color.
+    inline auto random_particle_init()
+    {
+        particle_init result;
+
+        auto x = random_float(left_bound, right_bound);
+        auto y = random_float(top_bound, bottom_bound);
+        result._position = vec2f{x, y};
+        result._radius = random_float(min_radius, max_radius);
+
+        result._velocity = random_vec2<vec2f>(-3, 3);
+        result._color = sfc(random_float(0, 255), random_float(0, 255),
+            random_float(0, 255), 255);
+
+        return result;
+    }
+
+    // Creates a particle for every element of `xs`.
+    // All the entities are created first, then their components are added
+    // one component type at a time, in entity ID order: every pass writes a
+    // single component array front to back.
+    template <typename TProxy>
+    void mk_particles(TProxy& proxy, dense_entities& particles,
+        const std::vector<particle_init>& xs)
+    {
+        std::vector<ecst::entity_id> eids;
+        eids.reserve(xs.size());
+        particles.create(proxy, xs.size(), std::back_inserter(eids));
+        std::sort(eids.begin(), eids.end());
+
+        auto add_all = [&](auto ct, auto&& f)
+        {
+            for(sz_t i = 0; i < eids.size(); ++i)
+            {
+                f(proxy.add_component(ct, eids[i]), xs[i]);
+            }
+        };
+
+        add_all(ct::acceleration, [](auto& c, const auto&)
+            {
+                c._v.y = 1;
+            });
+
+        add_all(ct::velocity, [](auto& c, const auto& x)
+            {
+                c._v = x._velocity;
+            });
+
+        add_all(ct::position, [](auto& c, const auto& x)
+            {
+                c._v = x._position;
+            });
+
+        add_all(ct::previous_position, [](auto& c, const auto& x)
+            {
+                c._v = x._position;
+            });
+
+        add_all(ct::color, [](auto& c, const auto& x)
+            {
+                c._v = x._color;
+            });
+
+        add_all(ct::circle, [](auto& c, const auto& x)
+            {
+                c._radius = x._radius;
+            });
+    }
+
+    // Creates `n` particles with random initial states.
+    template <typename TProxy>
+    void mk_random_particles(TProxy& proxy, dense_entities& particles, sz_t n)
+    {
+        std::vector<particle_init> xs;
+        xs.reserve(n);
+
+        for(sz_t i = 0; i < n; ++i)
+        {
+            xs.emplace_back(random_particle_init());
+        }
+
+        mk_particles(proxy, particles, xs);
     }
 
+    // Removes the particle `eid`. The particle with the highest entity ID
+    // takes its place (see `./utils/dense_entities.hpp`): both are removed
+    // from the spatial partitioning grid, and the moved one is inserted again
+    // by the next "Spatial partition" step.
     template <typename TProxy>
-    void mk_particle(TProxy& proxy, const vec2f& position, float radius)
+    void kill_particle(
+        TProxy& proxy, dense_entities& particles, ecst::entity_id eid)
+    {
+        auto& sp = proxy.system(st::spatial_partition);
+
+        particles.remove(proxy, eid,
+            [&sp](auto removed, auto moved)
+            {
+                sp.remove_entity(removed);
+                sp.remove_entity(moved);
+            },
+            ct::acceleration, ct::velocity, ct::position,
+            ct::previous_position, ct::color, ct::circle);
+    }
+
+    // Sorts the particles by the Z-order code of their grid cell (see
+    // `./utils/morton.hpp`), and gives them entity IDs in that order: the
+    // components of particles in nearby cells end up close in memory, and
+    // so do the neighbors read by the "Collision" system. Particles slowly
+    // drift away from that order, so this is meant to be executed
+    // periodically, after the systems (see `bench_code.cpp`).
+    // `on_remap(eid, new_eid)` is called for every particle, for any state
+    // indexed by entity ID outside of the systems.
+    template <typename TProxy, typename TF>
+    void reorder_particles(TProxy& proxy, dense_entities& particles,
+        TF&& on_remap)
     {
-        auto eid = proxy.create_entity();
+        using sp_type = s::spatial_partition;
+        auto& sp = proxy.system(st::spatial_partition);
+
+        static_assert(sp_type::grid_width <= (1 << 16) &&
+                          sp_type::grid_height <= (1 << 16),
+            "cell coordinates do not fit in a Morton code");
+
+        // Ties are broken by entity ID, so the order is reproducible.
+        const auto n = particles.size();
+        std::vector<std::pair<std::uint32_t, ecst::entity_id>> keys;
+        keys.reserve(n);
+
+        for(sz_t i = 0; i < n; ++i)
+        {
+            const auto eid = ecst::entity_id(i);
+            const auto& p = proxy.get_component(ct::position, eid)._v;
+            const auto x = static_cast<sz_t>(sp.idx(p.x)) + sp_type::offset;
+            const auto y = static_cast<sz_t>(sp.idx(p.y)) + sp_type::offset;
+
+            keys.emplace_back(morton_code(x, y), eid);
+        }
 
-        auto& ca = proxy.add_component(ct::acceleration, eid);
-        ca._v.y = 1;
+        std::sort(keys.begin(), keys.end());
 
-        auto& cv = proxy.add_component(ct::velocity, eid);
-        cv._v = rndvec2f(-3, 3);
+        std::vector<ecst::entity_id> order;
+        order.reserve(n);
+        for(const auto& k : keys) order.emplace_back(k.second);
 
-        auto& cp = proxy.add_component(ct::position, eid);
-        cp._v = position;
+        std::vector<ecst::entity_id> new_of(n);
+        particles.reorder(proxy, order,
+            [&new_of, &on_remap](auto eid, auto new_eid)
+            {
+                new_of[static_cast<sz_t>(eid)] = new_eid;
+                on_remap(eid, new_eid);
+            },
+            ct::acceleration, ct::velocity, ct::position,
+            ct::previous_position, ct::color, ct::circle);
 
-        auto& cclr = proxy.add_component(ct::color, eid);
-        cclr._v = sfc(rndf(0, 255), rndf(0, 255), rndf(0, 255), 255);
+        sp.remap_entities(new_of);
+    }
 
-        auto& ccs = proxy.add_component(ct::circle, eid);
-        ccs._radius = radius;
+    template <typename TProxy>
+    void reorder_particles(TProxy& proxy, dense_entities& particles)
+    {
+        reorder_particles(proxy, particles, [](auto, auto)
+            {
+            });
     }
 
+    // Creates `n` particles, tracked by `particles`. The simulation is
+    // reproducible when the random engine is seeded (see `seed_random`)
+    // before calling this function.
     template <typename TContext>
-    void init_ctx(TContext& ctx)
+    void init_ctx(TContext& ctx, dense_entities& particles,
+        sz_t n = initial_particle_count)
     {
-        auto random_position = []
-        {
-            return vec2f{                      
-                rndf(left_bound, right_bound), 
-                rndf(top_bound, bottom_bound)};
-        };
+        assert(fits_in_storage(particles.size() + n));
 
         ctx.step([&](auto& proxy)
             {
-                for(sz_t i = 0; i < initial_particle_count; ++i)
-                {
-                    mk_particle(proxy, random_position(), rndf(1, 4));
-                }
+                mk_random_particles(proxy, particles, n);
             });
     }
 
-    template <typename TContext, typename TRenderTarget>
-    void update_ctx(TContext& ctx, TRenderTarget& rt, ft dt)
+    // Creates `n` particles that will never be removed.
+    template <typename TContext>
+    void init_ctx(TContext& ctx, sz_t n = initial_particle_count)
+    {
+        dense_entities particles;
+        init_ctx(ctx, particles, n);
+    }
+
+    // Executes all the systems once, then calls `f(proxy)` in the same step,
+    // to consume their outputs. Circle instances are only generated if
+    // `emit` is `true`, interpolated by `alpha` (see
+    // `s::render_colored_circle`). Does not end the profiler frame.
+    template <typename TContext, typename TF>
+    void execute_step(TContext& ctx, ft dt, bool emit, float alpha, TF&& f)
     {
-        ctx.step([&rt, dt](auto& proxy)
+        ctx.step([dt, emit, alpha, &f](auto& proxy)
             {
-                proxy.system(st::spatial_partition).clear_cells();
+                proxy.system(st::spatial_partition).begin_frame();
+
+                // Recycle the output segments of the previous frame (of the
+                // frame before it, for the render system).
+                auto& rcc = proxy.system(st::render_colored_circle);
+                proxy.system(st::spatial_partition)._arena.reset();
+                rcc.flip_arenas();
+
+                rcc._emit = emit;
+                rcc._alpha = alpha;
 
                 proxy.execute_systems_overload( 
-                    [dt](s::acceleration& s, auto& data)
-                    {
-                        s.process(dt, data);
-                    },
-                    [dt](s::velocity& s, auto& data)
+                    [dt](s::integration& s, auto& data)
                     {
-                        s.process(dt, data);
+                        EXAMPLE_PROFILE_SCOPE("integration");
+                        s.process(data, dt);
                     },
-                    [](s::keep_in_bounds& s, auto& data)
+                    [](s::spatial_partition& s, auto& data)
                     {
+                        EXAMPLE_PROFILE_SCOPE("spatial_partition");
                         s.process(data);
                     },
-                    [](s::spatial_partition& s, auto& data)
+                    [](s::spatial_offsets& s, auto& data)
                     {
-                        s.process(data);
+                        EXAMPLE_PROFILE_SCOPE("spatial_offsets");
+                        s.execute(data);
                     },
                     [](s::spatial_filler& s, auto& data)
                     {
+                        EXAMPLE_PROFILE_SCOPE("spatial_filler");
                         s.execute(data);
                     },
                     [](s::collision& s, auto& data)
                     {
+                        EXAMPLE_PROFILE_SCOPE("collision");
                         s.process(data);
                     },
+                    [](s::contact_islands& s, auto& data)
+                    {
+                        EXAMPLE_PROFILE_SCOPE("contact_islands");
+                        s.execute(data);
+                    },
                     [](s::solve_contacts& s, auto& data)
                     {
+                        EXAMPLE_PROFILE_SCOPE("solve_contacts");
                         s.process(data);
                     },
                     [](s::render_colored_circle& s, auto& data)
                     {
+                        EXAMPLE_PROFILE_SCOPE("render_colored_circle");
                         s.process(data);
                     });
 
+                f(proxy);
+            });
+    }
+
+    template <typename TContext, typename TF>
+    void step_ctx(TContext& ctx, ft dt, bool emit, float alpha, TF&& f)
+    {
+        execute_step(ctx, dt, emit, alpha, f);
+        EXAMPLE_PROFILE_END_FRAME();
+    }
+
+    template <typename TContext, typename TF>
+    void step_ctx(TContext& ctx, ft dt, TF&& f)
+    {
+        step_ctx(ctx, dt, true, 1.f, f);
+    }
+
+    // Executes all the systems `k` times with a fixed timestep of `dt`, then
+    // calls `f(proxy)` in the last step. Only the last step generates circle
+    // instances, with positions interpolated between the last two steps by
+    // `alpha` (`1` places them at the final positions).
+    template <typename TContext, typename TF>
+    void step_ctx_n(TContext& ctx, ft dt, sz_t k, float alpha, TF&& f)
+    {
+        assert(k > 0);
+
+        auto consume_nothing = [](auto&)
+        {
+        };
+
+        for(sz_t i = 1; i < k; ++i)
+        {
+            step_ctx(ctx, dt, false, 1.f, consume_nothing);
+        }
+
+        step_ctx(ctx, dt, true, alpha, f);
+    }
+
+    // Executes the systems of a frame, then draws its circle instances.
+    template <typename TContext, typename TRenderTarget>
+    void update_ctx_serial(TContext& ctx, TRenderTarget& rt, ft dt)
+    {
+        step_ctx(ctx, dt, [&rt](auto& proxy)
+            {
+                EXAMPLE_PROFILE_SCOPE("draw");
+
+                auto& r = proxy.system(st::render_colored_circle)._renderer;
+                r.clear();
+
                 proxy.for_system_outputs(st::render_colored_circle,
-                    [&rt](auto&, auto& va)
+                    [&r](auto&, auto& out)
                     {
-                        rt.draw(va.data(), va.size(),
-                            sf::PrimitiveType::Triangles,
-                            sf::RenderStates::Default);
+                        r.add(out);
                     });
+
+                r.draw(rt);
             });
     }
+
+    // State of `update_ctx_pipelined` between frames.
+    struct frame_pipeline
+    {
+        // Executes the systems of the frames.
+        frame_worker _worker;
+
+        // Render system of the context, known after the first frame.
+        s::render_colored_circle* _rcc{nullptr};
+
+        // Output segments of the last executed frame, to be drawn during the
+        // next one, and of the executing frame.
+        std::vector<arena_segment<circle_instance>> _ready;
+        std::vector<arena_segment<circle_instance>> _pending;
+    };
+
+    // Like `update_ctx_serial`, but executes the systems of the current frame
+    // on the worker of `fp` while the calling thread draws the circle
+    // instances of the previous frame: the drawn particles are one frame
+    // behind the simulation. The instances of the previous frame live in the
+    // render system arena that is not used by the executing frame.
+    template <typename TContext, typename TRenderTarget>
+    void update_ctx_pipelined(
+        TContext& ctx, TRenderTarget& rt, ft dt, frame_pipeline& fp)
+    {
+        // `fp._rcc` is written again by the executing frame.
+        auto* rcc = fp._rcc;
+
+        auto execute = [&ctx, dt, &fp]
+        {
+            execute_step(ctx, dt, true, 1.f, [&fp](auto& proxy)
+                {
+                    fp._rcc = &proxy.system(st::render_colored_circle);
+                    fp._pending.clear();
+
+                    proxy.for_system_outputs(st::render_colored_circle,
+                        [&fp](auto&, auto& out)
+                        {
+                            fp._pending.emplace_back(out);
+                        });
+                });
+        };
+
+        fp._worker.start(execute);
+
+        if(rcc != nullptr)
+        {
+            EXAMPLE_PROFILE_SCOPE("draw");
+
+            auto& r = rcc->_renderer;
+            r.clear();
+
+            for(const auto& out : fp._ready)
+            {
+                r.add(out);
+            }
+
+            r.draw(rt);
+        }
+
+        fp._worker.wait();
+        std::swap(fp._ready, fp._pending);
+
+        EXAMPLE_PROFILE_END_FRAME();
+    }
+
+    template <typename TContext, typename TRenderTarget>
+    void update_ctx(frames::f_serial, TContext& ctx, TRenderTarget& rt, ft dt)
+    {
+        update_ctx_serial(ctx, rt, dt);
+    }
+
+    // The application only calls `update_ctx`: the pipeline lives as long
+    // as the program, and is only used by the frame loop's thread.
+    template <typename TContext, typename TRenderTarget>
+    void update_ctx(
+        frames::f_pipelined, TContext& ctx, TRenderTarget& rt, ft dt)
+    {
+        static frame_pipeline fp;
+        update_ctx_pipelined(ctx, rt, dt, fp);
+    }
+
+    // Executes and draws a frame (see `frame_execution`).
+    template <typename TContext, typename TRenderTarget>
+    void update_ctx(TContext& ctx, TRenderTarget& rt, ft dt)
+    {
+        update_ctx(frame_execution{}, ctx, rt, dt);
+    }
 }
 
+// The headless benchmark (`./bench_code.cpp`) reuses everything above.
+#if !defined(EXAMPLE_HEADLESS)
+
+#include <iostream>
 #include "./utils/pres_game_app.hpp"
 
 int main()
 {
-    // Namespace aliases.
-    using namespace example;
-    using namespace example::ecst_setup;
-    namespace cs = ecst::settings;
-    namespace ss = ecst::scheduler;
-
     // Define ECST context settings.
-    constexpr auto s = ecst::settings::make(            
-        cs::multithreaded(cs::allow_inner_parallelism), 
-        cs::fixed<entity_limit>,                        
-        make_csl(),                                     
-        make_ssl(),                                     
-        cs::scheduler<ss::s_atomic_counter>             
-        );
+    constexpr auto s = example::ecst_setup::make_settings();
 
     // Create an ECST context.
     auto ctx = ecst::context::make_uptr(s);
 
     // Run the simulation.
     run_simulation(*ctx);
-}
\ No newline at end of file
+
+#if defined(EXAMPLE_SCHEDULE_REPORT)
+    // Print the levels and the critical path of the system dependencies.
+    example::graph::write_schedule_report(std::cout,
+        example::ecst_setup::dependency_graph,
+        example::ecst_setup::dag::resource_names);
+#endif
+
+#if defined(EXAMPLE_PROFILING)
+    // Dump the collected profiling data.
+    auto& profiler = example::profiler::registry::instance();
+    profiler.write_report(std::cout);
+
+    std::ofstream trace{"profile_trace.json"};
+    profiler.write_chrome_trace(trace);
+#endif
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,420 @@
+// Copyright (c) 2015-2016 Vittorio Romeo
+// License: Academic Free License ("AFL") v. 3.0
+// AFL License page: http://opensource.org/licenses/AFL-3.0
+// http://vittorioromeo.info | vittorio.romeo@outlook.com
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+#include <SFML/Graphics.hpp>
+
+// Instanced drawing is the default, except in headless builds, which have no
+// OpenGL context, and with `EXAMPLE_NO_GL_INSTANCING` defined.
+#if !defined(EXAMPLE_HEADLESS) && !defined(EXAMPLE_NO_GL_INSTANCING)
+#define EXAMPLE_GL_INSTANCING
+#endif
+
+#if defined(EXAMPLE_GL_INSTANCING)
+#define GL_GLEXT_PROTOTYPES
+#include <iostream>
+#include <SFML/OpenGL.hpp>
+#include <GL/glext.h>
+#endif
+
+// Compact, per-instance render data for the particles.
+
+// Instead of building `3 * precision` vertices per particle, the render
+// system emits one `circle_instance` (16 bytes) per particle. The shape of
+// the circle is a triangle fan around the origin, computed once at compile
+// time, along with the unit offsets of all its vertices: the vertices of a
+// circle are generated by an unrolled scale-and-add over that table, with no
+// trigonometry at run time. `circle_renderer` turns the instances into a
+// single draw call:
+// * With `EXAMPLE_GL_INSTANCING` (the default), the fan is uploaded once,
+//   the instances are uploaded straight from the outputs of the render
+//   system and drawn with `glDrawArraysInstanced` (OpenGL 3.3).
+// * Otherwise, or if the shaders fail to compile or link, the instances are
+//   expanded on the CPU into a vertex buffer that is reused across frames.
+
+namespace example
+{
+    // Position, radius and color (packed RGBA bytes) of a particle.
+    struct circle_instance
+    {
+        float _x, _y;
+        float _radius;
+        std::uint8_t _rgba[4];
+    };
+
+    static_assert(sizeof(circle_instance) == 16, "");
+
+    namespace impl
+    {
+        // Taylor series approximations, only used at compile time.
+        constexpr double ct_pow_term(double x, std::size_t n) noexcept
+        {
+            double result = 1;
+            for(std::size_t i = 1; i <= n; ++i) result *= x / i;
+            return result;
+        }
+
+        constexpr double ct_sin(double x) noexcept
+        {
+            constexpr double pi = 3.14159265358979323846;
+            while(x > pi) x -= 2 * pi;
+            while(x < -pi) x += 2 * pi;
+
+            double result = 0;
+            for(std::size_t n = 1; n < 24; n += 4)
+            {
+                result += ct_pow_term(x, n) - ct_pow_term(x, n + 2);
+            }
+
+            return result;
+        }
+
+        constexpr double ct_cos(double x) noexcept
+        {
+            return ct_sin(x + 3.14159265358979323846 / 2);
+        }
+    }
+
+    // Unit-radius offsets of the `TPrecision + 1` boundary points of a
+    // circle, spaced by `inc` radians, and of the vertices of its triangles.
+    template <std::size_t TPrecision>
+    class circle_fan
+    {
+    public:
+        static constexpr std::size_t precision = TPrecision;
+        static constexpr std::size_t vertex_count = precision * 3;
+
+        struct point
+        {
+            float _x, _y;
+        };
+
+    private:
+        static constexpr point point_at(float inc, std::size_t i) noexcept
+        {
+            return {static_cast<float>(impl::ct_cos(inc * i)),
+                static_cast<float>(impl::ct_sin(inc * i))};
+        }
+
+        // Triangle `k / 3` is made of the center and of the boundary points
+        // `k / 3` and `k / 3 + 1`.
+        static constexpr point vertex_at(float inc, std::size_t k) noexcept
+        {
+            return k % 3 == 0 ? point{0.f, 0.f}
+                              : point_at(inc, k / 3 + k % 3 - 1);
+        }
+
+        template <std::size_t... TIs, std::size_t... TVs>
+        static constexpr auto make_points(float inc,
+            std::index_sequence<TIs...>, std::index_sequence<TVs...>) noexcept
+        {
+            return circle_fan{
+                {point_at(inc, TIs)...}, {vertex_at(inc, TVs)...}};
+        }
+
+        template <typename TF, std::size_t... TVs>
+        void for_vertices_impl(float x, float y, float r, TF& f,
+            std::index_sequence<TVs...>) const
+        {
+            using swallow = int[];
+            (void)swallow{0, (f(x + r * _vertices[TVs]._x,
+                                  y + r * _vertices[TVs]._y),
+                                 0)...};
+        }
+
+    public:
+        point _points[precision + 1];
+        point _vertices[vertex_count];
+
+        static constexpr auto make(float inc) noexcept
+        {
+            return make_points(inc,
+                std::make_index_sequence<precision + 1>{},
+                std::make_index_sequence<vertex_count>{});
+        }
+
+        // Invokes `f(x, y)` for the `vertex_count` vertices of the triangles
+        // of a circle with center `(x, y)` and radius `r`, in order. The loop
+        // is unrolled at compile time.
+        template <typename TF>
+        void for_vertices(float x, float y, float r, TF&& f) const
+        {
+            for_vertices_impl(
+                x, y, r, f, std::make_index_sequence<vertex_count>{});
+        }
+    };
+
+    // Collects the instances of a frame and draws them in one call.
+    template <std::size_t TPrecision>
+    class circle_renderer
+    {
+    private:
+        using fan_type = circle_fan<TPrecision>;
+        const fan_type& _fan;
+
+        // Instances added since the last `clear`, referenced in place.
+        struct span
+        {
+            const circle_instance* _data;
+            std::size_t _size;
+        };
+
+        std::vector<span> _spans;
+        std::size_t _instance_count{0};
+
+        // Vertices of the fallback path.
+        std::vector<sf::Vertex> _vertices;
+
+#if defined(EXAMPLE_GL_INSTANCING)
+        enum class gl_state
+        {
+            uninitialized,
+            ready,
+            failed
+        };
+
+        gl_state _gl{gl_state::uninitialized};
+        GLuint _program{0};
+        GLint _view_location{0};
+        GLuint _vao{0};
+        GLuint _fan_vbo{0};
+        GLuint _instance_vbo{0};
+
+        // Returns the compiled shader, or `0` after reporting its info log.
+        static GLuint compile(GLenum type, const char* source)
+        {
+            auto shader = glCreateShader(type);
+            glShaderSource(shader, 1, &source, nullptr);
+            glCompileShader(shader);
+
+            GLint ok = GL_FALSE;
+            glGetShaderiv(shader, GL_COMPILE_STATUS, &ok);
+            if(ok == GL_TRUE) return shader;
+
+            GLchar log[1024];
+            glGetShaderInfoLog(shader, sizeof(log), nullptr, log);
+            std::cerr << "circle_renderer: shader compilation failed:\n"
+                      << log << "\n";
+
+            glDeleteShader(shader);
+            return 0;
+        }
+
+        // Returns the linked program, or `0` after reporting its info log.
+        // The shaders are deleted in both cases.
+        static GLuint link(GLuint vs, GLuint fs)
+        {
+            auto program = glCreateProgram();
+            glAttachShader(program, vs);
+            glAttachShader(program, fs);
+            glLinkProgram(program);
+
+            glDetachShader(program, vs);
+            glDetachShader(program, fs);
+            glDeleteShader(vs);
+            glDeleteShader(fs);
+
+            GLint ok = GL_FALSE;
+            glGetProgramiv(program, GL_LINK_STATUS, &ok);
+            if(ok == GL_TRUE) return program;
+
+            GLchar log[1024];
+            glGetProgramInfoLog(program, sizeof(log), nullptr, log);
+            std::cerr << "circle_renderer: shader linking failed:\n"
+                      << log << "\n";
+
+            glDeleteProgram(program);
+            return 0;
+        }
+
+        // Returns `false` if the instanced path cannot be used.
+        bool init()
+        {
+            // Positions are mapped from world space to clip space with the
+            // matrix of the current view of the render target.
+            constexpr const char* vs_source = R"(
+                #version 330 core
+                layout(location = 0) in vec2 offset;
+                layout(location = 1) in vec3 instance;
+                layout(location = 2) in vec4 color;
+                uniform mat4 view;
+                out vec4 v_color;
+                void main()
+                {
+                    vec2 p = instance.xy + offset * instance.z;
+                    gl_Position = view * vec4(p, 0.0, 1.0);
+                    v_color = color;
+                })";
+
+            constexpr const char* fs_source = R"(
+                #version 330 core
+                in vec4 v_color;
+                out vec4 frag_color;
+                void main() { frag_color = v_color; })";
+
+            const auto vs = compile(GL_VERTEX_SHADER, vs_source);
+            const auto fs = compile(GL_FRAGMENT_SHADER, fs_source);
+
+            if(vs == 0 || fs == 0)
+            {
+                glDeleteShader(vs);
+                glDeleteShader(fs);
+                return false;
+            }
+
+            _program = link(vs, fs);
+            if(_program == 0) return false;
+
+            _view_location = glGetUniformLocation(_program, "view");
+
+            // Unit offsets of the triangles of a circle (center at origin).
+            std::vector<float> offsets;
+            offsets.reserve(fan_type::vertex_count * 2);
+            _fan.for_vertices(0.f, 0.f, 1.f, [&offsets](float x, float y)
+                {
+                    offsets.emplace_back(x);
+                    offsets.emplace_back(y);
+                });
+
+            glGenVertexArrays(1, &_vao);
+            glBindVertexArray(_vao);
+
+            glGenBuffers(1, &_fan_vbo);
+            glBindBuffer(GL_ARRAY_BUFFER, _fan_vbo);
+            glBufferData(GL_ARRAY_BUFFER, offsets.size() * sizeof(float),
+                offsets.data(), GL_STATIC_DRAW);
+            glEnableVertexAttribArray(0);
+            glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 0, nullptr);
+
+            constexpr auto stride = sizeof(circle_instance);
+            glGenBuffers(1, &_instance_vbo);
+            glBindBuffer(GL_ARRAY_BUFFER, _instance_vbo);
+            glEnableVertexAttribArray(1);
+            glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, stride, nullptr);
+            glVertexAttribDivisor(1, 1);
+
+            // The packed color is read as four normalized bytes.
+            glEnableVertexAttribArray(2);
+            glVertexAttribPointer(2, 4, GL_UNSIGNED_BYTE, GL_TRUE, stride,
+                reinterpret_cast<const void*>(3 * sizeof(float)));
+            glVertexAttribDivisor(2, 1);
+
+            glBindVertexArray(0);
+            return true;
+        }
+
+        template <typename TRenderTarget>
+        void draw_instanced(TRenderTarget& rt)
+        {
+            // Save the OpenGL states used by SFML.
+            rt.pushGLStates();
+
+            glUseProgram(_program);
+            glUniformMatrix4fv(_view_location, 1, GL_FALSE,
+                rt.getView().getTransform().getMatrix());
+
+            glBindVertexArray(_vao);
+            glBindBuffer(GL_ARRAY_BUFFER, _instance_vbo);
+
+            // Orphan the previous contents, then upload every span where it
+            // is, without gathering them first.
+            constexpr auto size = sizeof(circle_instance);
+            glBufferData(GL_ARRAY_BUFFER, _instance_count * size, nullptr,
+                GL_STREAM_DRAW);
+
+            std::size_t offset = 0;
+            for(const auto& x : _spans)
+            {
+                glBufferSubData(
+                    GL_ARRAY_BUFFER, offset * size, x._size * size, x._data);
+
+                offset += x._size;
+            }
+
+            glDrawArraysInstanced(GL_TRIANGLES, 0, fan_type::vertex_count,
+                static_cast<GLsizei>(_instance_count));
+
+            glBindVertexArray(0);
+            glUseProgram(0);
+            rt.popGLStates();
+        }
+#endif
+
+        // Expands the instances in place, without growing the buffer one
+        // vertex at a time.
+        void expand()
+        {
+            _vertices.resize(_instance_count * fan_type::vertex_count);
+            auto* out = _vertices.data();
+
+            for(const auto& s : _spans)
+            {
+                for(auto* x = s._data; x != s._data + s._size; ++x)
+                {
+                    const sf::Color c{
+                        x->_rgba[0], x->_rgba[1], x->_rgba[2], x->_rgba[3]};
+
+                    _fan.for_vertices(x->_x, x->_y, x->_radius,
+                        [&out, &c](float vx, float vy)
+                        {
+                            out->position = sf::Vector2f{vx, vy};
+                            out->color = c;
+                            ++out;
+                        });
+                }
+            }
+        }
+
+    public:
+        explicit circle_renderer(const fan_type& fan) noexcept : _fan{fan}
+        {
+        }
+
+        void clear() noexcept
+        {
+            _spans.clear();
+            _instance_count = 0;
+        }
+
+        // Adds the instances of `xs`, which are referenced: they have to
+        // stay alive and unchanged until the next `draw` returns.
+        template <typename TInstances>
+        void add(const TInstances& xs)
+        {
+            if(xs.size() == 0) return;
+
+            _spans.emplace_back(span{xs.data(), xs.size()});
+            _instance_count += xs.size();
+        }
+
+        template <typename TRenderTarget>
+        void draw(TRenderTarget& rt)
+        {
+            if(_instance_count == 0) return;
+
+#if defined(EXAMPLE_GL_INSTANCING)
+            if(_gl == gl_state::uninitialized)
+            {
+                _gl = init() ? gl_state::ready : gl_state::failed;
+            }
+
+            if(_gl == gl_state::ready)
+            {
+                draw_instanced(rt);
+                return;
+            }
+#endif
+
+            expand();
+            rt.draw(_vertices.data(), _vertices.size(),
+                sf::PrimitiveType::Triangles, sf::RenderStates::Default);
+        }
+    };
+}
@@ -0,0 +1,145 @@
+// Copyright (c) 2015-2016 Vittorio Romeo
+// License: Academic Free License ("AFL") v. 3.0
+// AFL License page: http://opensource.org/licenses/AFL-3.0
+// http://vittorioromeo.info | vittorio.romeo@outlook.com
+
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Entity removal with "swap-remove" compaction.
+
+// ECST indexes component storage by entity ID and hands out the IDs of killed
+// entities first when creating new ones. Killing arbitrary entities would
+// leave holes in the storage, that every `for_entities` scan, and every
+// `for_entity_chunks` run, has to skip. Instead, the components of the entity
+// with the highest ID are moved in place of the removed entity, and the
+// former is killed: the IDs of the live entities stay in `[0, size())`, so
+// that their components stay contiguous and entity iteration stays dense.
+
+// Entity IDs are therefore not stable across removals: state indexed by
+// entity ID has to be updated through the callback passed to `remove`. The
+// same applies to `reorder`, which permutes the live entities, for example to
+// lay out their components in spatial order.
+// Killed entities are only reclaimed by ECST at the end of a step: in the
+// same step, entities must be created before removing any.
+
+namespace example
+{
+    class dense_entities
+    {
+    private:
+        std::size_t _size{0};
+
+        // Moves the components tagged by `cts...` from `from` to `to`.
+        template <typename TProxy, typename TEntityID,
+            typename... TComponentTags>
+        static void move_components(TProxy& proxy, TEntityID from,
+            TEntityID to, TComponentTags... cts)
+        {
+            using swallow = int[];
+            (void)swallow{0, (proxy.get_component(cts, to) = std::move(
+                                  proxy.get_component(cts, from)),
+                                 0)...};
+        }
+
+        // Moves the component tagged by `ct` of `order[i]` to `i`, for every
+        // `i`.
+        template <typename TProxy, typename TEntityID, typename TComponentTag>
+        static void permute_components(TProxy& proxy,
+            const std::vector<TEntityID>& order, TComponentTag ct)
+        {
+            using component_type = std::decay_t<decltype(
+                proxy.get_component(ct, std::declval<TEntityID>()))>;
+
+            std::vector<component_type> moved;
+            moved.reserve(order.size());
+
+            for(auto eid : order)
+            {
+                moved.emplace_back(std::move(proxy.get_component(ct, eid)));
+            }
+
+            for(std::size_t i = 0; i < moved.size(); ++i)
+            {
+                proxy.get_component(ct, TEntityID(i)) = std::move(moved[i]);
+            }
+        }
+
+    public:
+        // Number of live entities.
+        auto size() const noexcept
+        {
+            return _size;
+        }
+
+        // Creates an entity. Its ID is in `[0, size())`.
+        template <typename TProxy>
+        auto create(TProxy& proxy)
+        {
+            auto eid = proxy.create_entity();
+            ++_size;
+
+            assert(static_cast<std::size_t>(eid) < _size);
+            return eid;
+        }
+
+        // Creates `n` entities, writing their IDs to `out`.
+        template <typename TProxy, typename TOut>
+        void create(TProxy& proxy, std::size_t n, TOut out)
+        {
+            for(std::size_t i = 0; i < n; ++i)
+            {
+                *out++ = create(proxy);
+            }
+        }
+
+        // Removes `eid`. The components tagged by `cts...` (which have to be
+        // all the components of the entities) of the entity with the highest
+        // ID are moved to `eid`. `on_move(eid, last)` is called beforehand,
+        // with the ID of the moved entity, even when `eid == last`.
+        template <typename TProxy, typename TEntityID, typename TF,
+            typename... TComponentTags>
+        void remove(TProxy& proxy, TEntityID eid, TF&& on_move,
+            TComponentTags... cts)
+        {
+            assert(_size > 0);
+            assert(static_cast<std::size_t>(eid) < _size);
+
+            const auto last = TEntityID(--_size);
+            on_move(eid, last);
+
+            if(eid != last)
+            {
+                move_components(proxy, last, eid, cts...);
+            }
+
+            proxy.kill_entity(last);
+        }
+
+        // Gives ID `i` to the entity `order[i]`, where `order` is a
+        // permutation of `[0, size())`. The components tagged by `cts...`
+        // (which have to be all the components of the entities) are moved
+        // accordingly. `on_remap(eid, new_eid)` is called for every entity
+        // beforehand.
+        template <typename TProxy, typename TEntityID, typename TF,
+            typename... TComponentTags>
+        void reorder(TProxy& proxy, const std::vector<TEntityID>& order,
+            TF&& on_remap, TComponentTags... cts)
+        {
+            assert(order.size() == _size);
+
+            for(std::size_t i = 0; i < _size; ++i)
+            {
+                on_remap(order[i], TEntityID(i));
+            }
+
+            using swallow = int[];
+            (void)swallow{0, (permute_components(proxy, order, cts), 0)...};
+        }
+    };
+}
@@ -0,0 +1,212 @@
+// Copyright (c) 2015-2016 Vittorio Romeo
+// License: Academic Free License ("AFL") v. 3.0
+// AFL License page: http://opensource.org/licenses/AFL-3.0
+// http://vittorioromeo.info | vittorio.romeo@outlook.com
+
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+
+// Batched iteration over the entities of a system-data proxy.
+// ECST stores the components contiguously, indexed by entity ID: a run of
+// consecutive IDs is therefore also a contiguous span of component storage,
+// which can be processed by streaming kernels instead of with one lookup per
+// entity. Removing entities with `dense_entities` keeps the runs long.
+
+namespace example
+{
+    // Maximum number of entities in a chunk. Keeps the components touched by
+    // a chunk small enough to stay in L1 while every kernel runs over it.
+    constexpr std::size_t max_entity_chunk_size = 256;
+
+    // A run of entities with consecutive IDs.
+    template <typename TData>
+    class entity_chunk
+    {
+    private:
+        TData& _data;
+        std::size_t _first;
+        std::size_t _size;
+
+    public:
+        entity_chunk(TData& data, std::size_t first, std::size_t size) noexcept
+            : _data(data), _first{first}, _size{size}
+        {
+        }
+
+        // ID of the first entity of the chunk.
+        auto first() const noexcept
+        {
+            return _first;
+        }
+
+        // Number of entities in the chunk.
+        auto size() const noexcept
+        {
+            return _size;
+        }
+
+        // Returns a pointer to the first of `size()` contiguous instances of
+        // the component tagged by `ct`.
+        template <typename TComponentTag>
+        auto get(TComponentTag ct) const noexcept
+        {
+            auto* p = &_data.get(ct, ecst::entity_id(_first));
+
+            assert(&_data.get(ct, ecst::entity_id(_first + _size - 1)) ==
+                   p + _size - 1);
+
+            return p;
+        }
+    };
+
+    // Executes `f` on every chunk of consecutive entity IDs of the subtask
+    // owning `data`. Entities are visited in the same order as
+    // `data.for_entities`.
+    template <typename TData, typename TF>
+    void for_entity_chunks(TData& data, TF&& f)
+    {
+        std::size_t first = 0;
+        std::size_t size = 0;
+
+        auto flush = [&]
+        {
+            if(size == 0) return;
+
+            entity_chunk<TData> chunk{data, first, size};
+            f(chunk);
+            size = 0;
+        };
+
+        data.for_entities([&](auto eid)
+            {
+                const auto i = static_cast<std::size_t>(eid);
+
+                if(size == max_entity_chunk_size || i != first + size)
+                {
+                    flush();
+                    first = i;
+                }
+
+                ++size;
+            });
+
+        flush();
+    }
+
+    namespace impl
+    {
+        template <typename TChunk, typename TF, typename... Ts>
+        void for_chunk_entities(TChunk& chunk, TF& f, Ts*... ps)
+        {
+            for(std::size_t i = 0; i < chunk.size(); ++i)
+            {
+                f(ecst::entity_id(chunk.first() + i), ps[i]...);
+            }
+        }
+    }
+
+    // Returns a function that executes `f(eid, components...)` on every
+    // entity of the subtask owning `data`, where `components...` are the
+    // components tagged by `cts...`. Component storage is resolved once per
+    // chunk, instead of once per entity and component:
+    /*
+        for_entities_with(data, ct::position, ct::circle)(
+            [](auto eid, auto& p, auto& c)
+            {
+                // ...
+            });
+    */
+    template <typename TData, typename... TComponentTags>
+    auto for_entities_with(TData& data, TComponentTags... cts)
+    {
+        return [&data, cts...](auto&& f)
+        {
+            for_entity_chunks(data, [&f, cts...](auto& chunk)
+                {
+                    impl::for_chunk_entities(chunk, f, chunk.get(cts)...);
+                });
+        };
+    }
+
+    namespace impl
+    {
+        template <typename TData, typename TComponentTag>
+        using component_type =
+            std::remove_reference_t<decltype(std::declval<TData&>().get(
+                std::declval<TComponentTag>(),
+                std::declval<ecst::entity_id>()))>;
+
+        template <typename TComponentTag, typename T>
+        struct component_base
+        {
+            T* _base;
+        };
+
+        // Deduces `T` from the only base class for `TComponentTag`.
+        template <typename TComponentTag, typename T>
+        T* base_of(const component_base<TComponentTag, T>& b) noexcept
+        {
+            return b._base;
+        }
+    }
+
+    // Random access to the components tagged by `TComponentTags...`, by
+    // entity ID, through pointers to their storage resolved once. Exposes
+    // the same `get(ct, eid)` interface as `TData`, therefore it can replace
+    // the data proxy in code that only accesses components.
+    // The storage is located with a single lookup of the components of
+    // `anchor`, which can be any entity subscribed to the system.
+    template <typename TData, typename... TComponentTags>
+    class cached_components
+        : public impl::component_base<TComponentTags,
+              impl::component_type<TData, TComponentTags>>...
+    {
+    private:
+        TData& _data;
+
+        // Components are stored in a single array indexed by entity ID: the
+        // base is the address of the component of entity `0`.
+        template <typename TComponentTag>
+        static auto base_from(
+            TData& data, TComponentTag ct, ecst::entity_id anchor) noexcept
+        {
+            const auto i = static_cast<std::size_t>(anchor);
+            return &data.get(ct, anchor) - i;
+        }
+
+    public:
+        cached_components(TData& data, ecst::entity_id anchor,
+            TComponentTags... cts) noexcept
+            : impl::component_base<TComponentTags,
+                  impl::component_type<TData, TComponentTags>>{base_from(
+                  data, cts, anchor)}...,
+              _data(data)
+        {
+        }
+
+        template <typename TComponentTag>
+        auto& get(TComponentTag ct, ecst::entity_id eid) const noexcept
+        {
+            auto& result = impl::base_of<TComponentTag>(
+                *this)[static_cast<std::size_t>(eid)];
+
+            // Also checks that the storage is contiguous.
+            assert(&result == &_data.get(ct, eid));
+            (void)ct;
+
+            return result;
+        }
+    };
+
+    template <typename TData, typename... TComponentTags>
+    auto cache_components(TData& data, ecst::entity_id anchor,
+        TComponentTags... cts) noexcept
+    {
+        return cached_components<TData, TComponentTags...>{
+            data, anchor, cts...};
+    }
+}
@@ -0,0 +1,139 @@
+// Copyright (c) 2015-2016 Vittorio Romeo
+// License: Academic Free License ("AFL") v. 3.0
+// AFL License page: http://opensource.org/licenses/AFL-3.0
+// http://vittorioromeo.info | vittorio.romeo@outlook.com
+
+#pragma once
+
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+// Frame-scoped storage for system outputs.
+
+// A system owns a `frame_arena`, and every one of its subtasks acquires a
+// segment of it, sized with an upper bound of the data it will produce. The
+// segment is then used as the subtask output (`ss::output::data<...>`).
+// Segments are carved out of a single buffer with an atomic bump pointer:
+// when the buffer runs out during a frame, segments are allocated separately
+// and the buffer grows to the frame's high-water mark on the next `reset`.
+// Steady-state frames perform no heap allocations.
+
+namespace example
+{
+    // Contiguous, fixed-capacity output of a subtask.
+    template <typename T>
+    class arena_segment
+    {
+    private:
+        T* _data{nullptr};
+        std::size_t _size{0};
+        std::size_t _capacity{0};
+
+    public:
+        arena_segment() = default;
+
+        arena_segment(T* data, std::size_t capacity) noexcept
+            : _data{data}, _capacity{capacity}
+        {
+        }
+
+        template <typename... Ts>
+        auto& emplace_back(Ts&&... xs) noexcept
+        {
+            assert(_size < _capacity);
+            return _data[_size++] = T{std::forward<Ts>(xs)...};
+        }
+
+        void clear() noexcept
+        {
+            _size = 0;
+        }
+
+        auto data() const noexcept
+        {
+            return _data;
+        }
+
+        auto size() const noexcept
+        {
+            return _size;
+        }
+
+        auto capacity() const noexcept
+        {
+            return _capacity;
+        }
+
+        auto begin() const noexcept
+        {
+            return _data;
+        }
+
+        auto end() const noexcept
+        {
+            return _data + _size;
+        }
+
+        auto& operator[](std::size_t i) const noexcept
+        {
+            assert(i < _size);
+            return _data[i];
+        }
+    };
+
+    template <typename T>
+    class frame_arena
+    {
+    private:
+        // Main buffer, sized after the high-water mark of previous frames.
+        std::vector<T> _buffer;
+
+        // Bump pointer into `_buffer`, and total capacity requested during
+        // the current frame.
+        std::atomic<std::size_t> _used{0};
+        std::atomic<std::size_t> _demand{0};
+
+        // Segments that did not fit in `_buffer` during the current frame.
+        std::mutex _overflow_mutex;
+        std::vector<std::unique_ptr<T[]>> _overflow;
+
+    public:
+        // Recycles every segment acquired during the previous frame.
+        // Must not be called while subtasks are using the arena.
+        void reset()
+        {
+            const auto demand = _demand.load();
+            if(demand > _buffer.size())
+            {
+                // Leave some headroom for frames with slightly more output.
+                _buffer.resize(demand + demand / 4);
+            }
+
+            _overflow.clear();
+            _used = 0;
+            _demand = 0;
+        }
+
+        // Acquires a segment that can hold up to `capacity` items.
+        // Thread-safe.
+        auto acquire(std::size_t capacity)
+        {
+            _demand += capacity;
+
+            const auto begin = _used.fetch_add(capacity);
+            if(begin + capacity <= _buffer.size())
+            {
+                return arena_segment<T>{_buffer.data() + begin, capacity};
+            }
+
+            std::lock_guard<std::mutex> lock{_overflow_mutex};
+            _overflow.emplace_back(std::make_unique<T[]>(capacity));
+            return arena_segment<T>{_overflow.back().get(), capacity};
+        }
+    };
+}
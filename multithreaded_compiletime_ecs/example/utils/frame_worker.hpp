@@ -0,0 +1,151 @@
+// Copyright (c) 2015-2016 Vittorio Romeo
+// License: Academic Free License ("AFL") v. 3.0
+// AFL License page: http://opensource.org/licenses/AFL-3.0
+// http://vittorioromeo.info | vittorio.romeo@outlook.com
+
+#pragma once
+
+#include <cassert>
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <thread>
+
+// Persistent thread that executes one job at a time, on behalf of the thread
+// that starts it.
+
+// Used to overlap the systems of a frame with the drawing of the previous
+// one, without creating a thread every frame. Jobs are referenced, not
+// copied: the caller keeps its job alive until `wait` returns, which also
+// rethrows the exception the job exited with, if any.
+/*
+    frame_worker w;
+
+    auto job = [&]{ ... };
+    w.start(job);
+    // ...runs concurrently with `job`...
+    w.wait();
+*/
+
+namespace example
+{
+    class frame_worker
+    {
+    private:
+        std::mutex _mutex;
+        std::condition_variable _cv;
+
+        // Type-erased reference to the job being executed, if any.
+        const void* _job_ctx{nullptr};
+        void (*_job_fn)(const void*){nullptr};
+
+        bool _busy{false};
+        bool _stop{false};
+        std::exception_ptr _error;
+
+        std::thread _thread;
+
+        void run()
+        {
+            std::unique_lock<std::mutex> lock{_mutex};
+
+            while(true)
+            {
+                _cv.wait(lock, [this]
+                    {
+                        return _stop || _job_fn != nullptr;
+                    });
+
+                if(_stop) return;
+
+                const auto* ctx = _job_ctx;
+                auto* fn = _job_fn;
+                lock.unlock();
+
+                std::exception_ptr error;
+                try
+                {
+                    fn(ctx);
+                }
+                catch(...)
+                {
+                    error = std::current_exception();
+                }
+
+                lock.lock();
+                _error = error;
+                _job_fn = nullptr;
+                _busy = false;
+                _cv.notify_all();
+            }
+        }
+
+    public:
+        frame_worker() : _thread{[this]
+                             {
+                                 run();
+                             }}
+        {
+        }
+
+        frame_worker(const frame_worker&) = delete;
+        frame_worker& operator=(const frame_worker&) = delete;
+
+        ~frame_worker()
+        {
+            wait_idle();
+
+            {
+                std::lock_guard<std::mutex> lock{_mutex};
+                _stop = true;
+            }
+
+            _cv.notify_all();
+            _thread.join();
+        }
+
+        // Starts executing `f()` on the worker. The previous job has to be
+        // waited for, and `f` has to outlive the next `wait`.
+        template <typename TF>
+        void start(const TF& f)
+        {
+            std::lock_guard<std::mutex> lock{_mutex};
+            assert(!_busy);
+
+            _job_ctx = &f;
+            _job_fn = [](const void* ctx)
+            {
+                (*static_cast<const TF*>(ctx))();
+            };
+
+            _busy = true;
+            _cv.notify_all();
+        }
+
+        // Blocks until the current job (if any) is complete, without
+        // rethrowing its exception.
+        void wait_idle()
+        {
+            std::unique_lock<std::mutex> lock{_mutex};
+            _cv.wait(lock, [this]
+                {
+                    return !_busy;
+                });
+        }
+
+        // Blocks until the current job (if any) is complete, and rethrows the
+        // exception it exited with.
+        void wait()
+        {
+            wait_idle();
+
+            std::exception_ptr error;
+            {
+                std::lock_guard<std::mutex> lock{_mutex};
+                std::swap(error, _error);
+            }
+
+            if(error) std::rethrow_exception(error);
+        }
+    };
+}
@@ -0,0 +1,62 @@
+// Copyright (c) 2015-2016 Vittorio Romeo
+// License: Academic Free License ("AFL") v. 3.0
+// AFL License page: http://opensource.org/licenses/AFL-3.0
+// http://vittorioromeo.info | vittorio.romeo@outlook.com
+
+#pragma once
+
+#include <utility>
+#include "./entity_chunks.hpp"
+
+// Compile-time fusion of systems that form a dependency chain over the same
+// set of entities, with the same inner parallelism strategy.
+
+// Every fused system must expose a `process_chunk` method, taking either the
+// extra arguments forwarded to the fused system followed by the chunk, or the
+// chunk alone. The fused system visits the entities once: every kernel runs
+// over a chunk before moving to the next one, so the components of a chunk
+// are brought in cache once per frame and only one task dispatch and join is
+// required for the whole chain.
+
+// Its signature must be the union of the component uses of the fused
+// systems, replacing them in the system signature list.
+
+namespace example
+{
+    namespace impl
+    {
+        // Preferred overload: the kernel accepts the extra arguments.
+        template <typename TSystem, typename TChunk, typename... Ts>
+        auto process_chunk(int, TSystem& s, TChunk& chunk, const Ts&... xs)
+            -> decltype(s.process_chunk(xs..., chunk), void())
+        {
+            s.process_chunk(xs..., chunk);
+        }
+
+        // Fallback overload: the kernel only needs the chunk.
+        template <typename TSystem, typename TChunk, typename... Ts>
+        auto process_chunk(long, TSystem& s, TChunk& chunk, const Ts&...)
+            -> decltype(s.process_chunk(chunk), void())
+        {
+            s.process_chunk(chunk);
+        }
+    }
+
+    template <typename... TSystems>
+    struct fused : TSystems...
+    {
+        template <typename TData, typename... Ts>
+        void process(TData& data, const Ts&... xs)
+        {
+            for_entity_chunks(data, [this, &xs...](auto& chunk)
+                {
+                    // Run the kernels in declaration order.
+                    using swallow = int[];
+                    (void)swallow{(impl::process_chunk(0,
+                                       static_cast<TSystems&>(*this), chunk,
+                                       xs...),
+                        0)...};
+                });
+        }
+    };
+}
@@ -0,0 +1,117 @@
+// Copyright (c) 2015-2016 Vittorio Romeo
+// License: Academic Free License ("AFL") v. 3.0
+// AFL License page: http://opensource.org/licenses/AFL-3.0
+// http://vittorioromeo.info | vittorio.romeo@outlook.com
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include "./work_stealing.hpp"
+
+// Runtime choice of the grain of `work_stealing_pool::parallel_for`, from the
+// measured cost of the previous calls.
+
+// Every block of every call is timed, and the cost per item (the time spent
+// in the blocks divided by the number of items, which does not depend on how
+// many threads ran them) is smoothed with an exponential moving average. The
+// next grain is the number of items that takes about `target_block_ns` to
+// process, so that the overhead of a block
+// (splitting, stealing, the call to the body) stays small compared to its
+// work, within the following limits:
+// * There are at least `blocks_per_thread` blocks per thread, so that idle
+//   threads can always steal.
+// * The grain stays within the `[min, max]` bounds of the tuner.
+// The grain only changes when the new one differs from the current one by
+// more than `hysteresis`, so that noise in the measurements does not change
+// the block layout at every frame.
+
+namespace example
+{
+    class grain_tuner
+    {
+    public:
+        static constexpr double target_block_ns = 20000;
+        static constexpr double smoothing = 0.25;
+        static constexpr double hysteresis = 0.25;
+        static constexpr std::size_t blocks_per_thread = 4;
+
+    private:
+        std::size_t _grain;
+        std::size_t _min_grain;
+        std::size_t _max_grain;
+
+        // Smoothed cost of an item, `0` before the first measurement.
+        double _ns_per_item{0};
+
+    public:
+        // With `min_grain == max_grain`, the grain never changes.
+        grain_tuner(std::size_t initial, std::size_t min_grain,
+            std::size_t max_grain) noexcept
+            : _grain{initial}, _min_grain{min_grain}, _max_grain{max_grain}
+        {
+        }
+
+        auto grain() const noexcept
+        {
+            return _grain;
+        }
+
+        // Records that processing `n` items with `thread_count` threads took
+        // `busy_ns` nanoseconds in total, summed over all the blocks, and
+        // picks the grain of the next calls.
+        void record(
+            std::size_t n, std::size_t thread_count, double busy_ns) noexcept
+        {
+            if(n == 0) return;
+
+            const auto cost = busy_ns / n;
+            _ns_per_item =
+                _ns_per_item == 0
+                    ? cost
+                    : _ns_per_item + (cost - _ns_per_item) * smoothing;
+
+            auto g = _ns_per_item > 0
+                         ? static_cast<std::size_t>(
+                               target_block_ns / _ns_per_item)
+                         : _max_grain;
+
+            const auto max_blocks = std::max(thread_count, std::size_t(1)) *
+                                    blocks_per_thread;
+
+            g = std::min(g, n / max_blocks);
+            g = std::max(std::min(g, _max_grain), _min_grain);
+
+            const auto delta = g > _grain ? g - _grain : _grain - g;
+            if(delta > _grain * hysteresis) _grain = g;
+        }
+
+        // Executes `pool.parallel_for(n, grain(), f)`, and records the time
+        // spent in its blocks. Returns the grain that was used.
+        template <typename TF>
+        auto parallel_for(work_stealing_pool& pool, std::size_t n, const TF& f)
+        {
+            using clock = std::chrono::steady_clock;
+
+            const auto g = _grain;
+            std::atomic<std::int64_t> busy_ns{0};
+
+            pool.parallel_for(n, g, [&f, &busy_ns](auto b, auto e)
+                {
+                    const auto begin = clock::now();
+                    f(b, e);
+                    const auto end = clock::now();
+
+                    using ns = std::chrono::nanoseconds;
+                    busy_ns +=
+                        std::chrono::duration_cast<ns>(end - begin).count();
+                });
+
+            record(n, pool.thread_count(), busy_ns.load());
+            return g;
+        }
+    };
+}
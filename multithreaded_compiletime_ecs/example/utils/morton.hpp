@@ -0,0 +1,44 @@
+// Copyright (c) 2015-2016 Vittorio Romeo
+// License: Academic Free License ("AFL") v. 3.0
+// AFL License page: http://opensource.org/licenses/AFL-3.0
+// http://vittorioromeo.info | vittorio.romeo@outlook.com
+
+#pragma once
+
+#include <cstdint>
+
+// Z-order ("Morton") codes of 2D grid coordinates.
+
+// The code of `(x, y)` interleaves the bits of the coordinates (`x` in the
+// even bits, `y` in the odd ones). Sorting cells by their code keeps cells
+// that are close on the grid close in the sorted sequence, along both axes.
+
+namespace example
+{
+    namespace impl
+    {
+        // Moves the lower 16 bits of `x` to the even bits of the result.
+        constexpr std::uint32_t spread_bits(std::uint32_t x) noexcept
+        {
+            x &= 0x0000ffff;
+            x = (x | (x << 8)) & 0x00ff00ff;
+            x = (x | (x << 4)) & 0x0f0f0f0f;
+            x = (x | (x << 2)) & 0x33333333;
+            x = (x | (x << 1)) & 0x55555555;
+            return x;
+        }
+    }
+
+    // Coordinates have to be lower than `2^16`.
+    constexpr std::uint32_t morton_code(
+        std::uint32_t x, std::uint32_t y) noexcept
+    {
+        return impl::spread_bits(x) | (impl::spread_bits(y) << 1);
+    }
+
+    static_assert(morton_code(0, 0) == 0, "");
+    static_assert(morton_code(1, 0) == 1, "");
+    static_assert(morton_code(0, 1) == 2, "");
+    static_assert(morton_code(3, 3) == 15, "");
+    static_assert(morton_code(4, 0) == 16, "");
+}
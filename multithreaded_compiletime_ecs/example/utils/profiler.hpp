@@ -0,0 +1,365 @@
+// Copyright (c) 2015-2016 Vittorio Romeo
+// License: Academic Free License ("AFL") v. 3.0
+// AFL License page: http://opensource.org/licenses/AFL-3.0
+// http://vittorioromeo.info | vittorio.romeo@outlook.com
+
+#pragma once
+
+// Opt-in instrumentation of the frame pipeline.
+
+// Define `EXAMPLE_PROFILING` to enable it. Otherwise, every macro below
+// expands to nothing and no profiling code is compiled.
+/*
+    * `EXAMPLE_PROFILE_SCOPE("name")`: records the duration of the enclosing
+      scope, on the calling thread. Wrapping a system's execution lambda
+      records one event per subtask.
+
+    * `EXAMPLE_PROFILE_END_FRAME()`: aggregates the events of the current
+      frame. Must be called when no instrumented code is running.
+*/
+
+// Every thread records its events in its own ring buffer, with no locks and
+// no allocations (a thread only registers its buffer the first time it
+// records an event). The buffers can be dumped as a Chrome `trace_event`
+// JSON file (`chrome://tracing`), where dependency waits show up as gaps
+// between the systems, together with a per-system report of the frame-span
+// percentiles (time between the first subtask start and the last subtask end
+// of a system in a frame).
+
+#if defined(EXAMPLE_PROFILING)
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <vector>
+
+#define EXAMPLE_PROFILE_IMPL_CAT_1(a, b) a##b
+#define EXAMPLE_PROFILE_IMPL_CAT(a, b) EXAMPLE_PROFILE_IMPL_CAT_1(a, b)
+
+#define EXAMPLE_PROFILE_SCOPE(name)                       \
+    ::example::profiler::scope EXAMPLE_PROFILE_IMPL_CAT( \
+        example_profile_scope_, __LINE__)                 \
+    {                                                     \
+        name                                              \
+    }
+
+#define EXAMPLE_PROFILE_END_FRAME() ::example::profiler::end_frame()
+
+namespace example
+{
+    namespace profiler
+    {
+        using clock = std::chrono::steady_clock;
+
+        // Nanoseconds since the first call.
+        inline std::uint64_t now() noexcept
+        {
+            static const auto start = clock::now();
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                clock::now() - start)
+                .count();
+        }
+
+        struct event
+        {
+            const char* _name;
+            std::uint64_t _begin, _end;
+        };
+
+        // Single-producer ring buffer, owned by one thread.
+        class thread_buffer
+        {
+        public:
+            static constexpr std::size_t capacity = 1 << 16;
+
+        private:
+            std::vector<event> _events;
+            std::atomic<std::size_t> _written{0};
+            std::size_t _aggregated{0};
+            std::size_t _tid;
+
+        public:
+            explicit thread_buffer(std::size_t tid)
+                : _events(capacity), _tid{tid}
+            {
+            }
+
+            void record(const event& e) noexcept
+            {
+                const auto i = _written.load(std::memory_order_relaxed);
+                _events[i % capacity] = e;
+                _written.store(i + 1, std::memory_order_release);
+            }
+
+            auto tid() const noexcept
+            {
+                return _tid;
+            }
+
+            // Executes `f` on the events still in the buffer, starting from
+            // the `from`-th recorded one.
+            template <typename TF>
+            void for_events_since(std::size_t from, TF&& f) const
+            {
+                const auto to = _written.load(std::memory_order_acquire);
+                from = std::max(from, to < capacity ? 0 : to - capacity);
+
+                for(auto i = from; i < to; ++i)
+                {
+                    f(_events[i % capacity]);
+                }
+            }
+
+            // Executes `f` on the events recorded since the last call.
+            template <typename TF>
+            void for_new_events(TF&& f)
+            {
+                for_events_since(_aggregated, f);
+                _aggregated = _written.load(std::memory_order_acquire);
+            }
+
+            template <typename TF>
+            void for_retained_events(TF&& f) const
+            {
+                for_events_since(0, f);
+            }
+        };
+
+        class registry
+        {
+        public:
+            // Maximum number of distinct event names. Events with further
+            // names are only written to the trace.
+            static constexpr std::size_t max_names = 64;
+
+        private:
+            static constexpr auto npos = max_names;
+
+            struct span
+            {
+                std::uint64_t _begin, _end;
+            };
+
+            std::mutex _mutex;
+            std::vector<std::unique_ptr<thread_buffer>> _buffers;
+
+            // Every distinct event name, in order of appearance, and the
+            // frame spans (in nanoseconds) of the events carrying it.
+            std::array<const char*, max_names> _names{};
+            std::size_t _name_count{0};
+            std::array<std::vector<std::uint64_t>, max_names> _spans;
+
+            // Returns the index of `name` in `_names`, adding it if needed,
+            // or `npos` if it is full. The same name can be passed as
+            // distinct, but equal, string literals: they are only compared
+            // by content when no pointer matches.
+            auto intern(const char* name) noexcept
+            {
+                for(std::size_t i = 0; i < _name_count; ++i)
+                {
+                    if(_names[i] == name) return i;
+                }
+
+                for(std::size_t i = 0; i < _name_count; ++i)
+                {
+                    if(std::strcmp(_names[i], name) == 0) return i;
+                }
+
+                if(_name_count == max_names) return npos;
+
+                _names[_name_count] = name;
+                return _name_count++;
+            }
+
+        public:
+            static auto& instance()
+            {
+                static registry r;
+                return r;
+            }
+
+            auto& register_thread()
+            {
+                std::lock_guard<std::mutex> lock{_mutex};
+                _buffers.emplace_back(
+                    std::make_unique<thread_buffer>(_buffers.size()));
+
+                return *_buffers.back();
+            }
+
+            void end_frame()
+            {
+                std::lock_guard<std::mutex> lock{_mutex};
+
+                // Span of every name in the current frame. Names without
+                // events keep an empty span.
+                std::array<span, max_names> frame;
+                frame.fill(
+                    span{std::numeric_limits<std::uint64_t>::max(), 0});
+
+                for(auto& b : _buffers)
+                {
+                    b->for_new_events([&](const event& e)
+                        {
+                            const auto i = this->intern(e._name);
+                            if(i == npos) return;
+
+                            auto& x = frame[i];
+                            x._begin = std::min(x._begin, e._begin);
+                            x._end = std::max(x._end, e._end);
+                        });
+                }
+
+                for(std::size_t i = 0; i < _name_count; ++i)
+                {
+                    if(frame[i]._begin > frame[i]._end) continue;
+                    _spans[i].emplace_back(frame[i]._end - frame[i]._begin);
+                }
+            }
+
+            void clear()
+            {
+                std::lock_guard<std::mutex> lock{_mutex};
+                for(auto& b : _buffers)
+                {
+                    b->for_new_events([](const event&)
+                        {
+                        });
+                }
+
+                for(auto& x : _spans) x.clear();
+            }
+
+            // Writes the retained events in Chrome `trace_event` format.
+            void write_chrome_trace(std::ostream& os)
+            {
+                std::lock_guard<std::mutex> lock{_mutex};
+                bool first = true;
+
+                os << "{\"traceEvents\":[\n";
+                for(auto& b : _buffers)
+                {
+                    b->for_retained_events([&](const event& e)
+                        {
+                            os << (first ? "" : ",\n")               // .
+                               << "{\"name\":\"" << e._name          // .
+                               << "\",\"ph\":\"X\",\"pid\":0,\"tid\":" // .
+                               << b->tid()                           // .
+                               << ",\"ts\":" << e._begin / 1000.0    // .
+                               << ",\"dur\":"                        // .
+                               << (e._end - e._begin) / 1000.0 << "}";
+
+                            first = false;
+                        });
+                }
+
+                os << "\n]}\n";
+            }
+
+            // Executes `f(name, mean, p50, p90, p99)` for every system, in
+            // name order, with frame-span statistics in milliseconds.
+            template <typename TF>
+            void for_statistics(TF&& f)
+            {
+                std::lock_guard<std::mutex> lock{_mutex};
+
+                std::vector<std::size_t> ids;
+                for(std::size_t i = 0; i < _name_count; ++i)
+                {
+                    if(!_spans[i].empty()) ids.emplace_back(i);
+                }
+
+                std::sort(ids.begin(), ids.end(), [this](auto a, auto b)
+                    {
+                        return std::strcmp(_names[a], _names[b]) < 0;
+                    });
+
+                for(auto i : ids)
+                {
+                    auto v = _spans[i];
+                    std::sort(v.begin(), v.end());
+
+                    auto pct = [&v](double p)
+                    {
+                        auto i = static_cast<std::size_t>(p * (v.size() - 1));
+                        return v[i] / 1e6;
+                    };
+
+                    double sum = 0;
+                    for(auto y : v) sum += y;
+
+                    f(_names[i], sum / v.size() / 1e6, pct(0.5), pct(0.9),
+                        pct(0.99));
+                }
+            }
+
+            void write_report(std::ostream& os)
+            {
+                os << std::left << std::setw(24) << "system" << std::right
+                   << std::setw(10) << "mean ms" << std::setw(10) << "p50"
+                   << std::setw(10) << "p90" << std::setw(10) << "p99"
+                   << "\n";
+
+                for_statistics([&os](const auto& name, auto mean, auto p50,
+                    auto p90, auto p99)
+                    {
+                        os << std::left << std::setw(24) << name
+                           << std::right << std::fixed
+                           << std::setprecision(3) << std::setw(10) << mean
+                           << std::setw(10) << p50 << std::setw(10) << p90
+                           << std::setw(10) << p99 << "\n";
+                    });
+            }
+        };
+
+        inline auto& this_thread_buffer()
+        {
+            thread_local auto& b = registry::instance().register_thread();
+            return b;
+        }
+
+        class scope
+        {
+        private:
+            const char* _name;
+            std::uint64_t _begin;
+
+        public:
+            explicit scope(const char* name) noexcept
+                : _name{name}, _begin{now()}
+            {
+            }
+
+            scope(const scope&) = delete;
+            scope& operator=(const scope&) = delete;
+
+            ~scope()
+            {
+                this_thread_buffer().record(event{_name, _begin, now()});
+            }
+        };
+
+        inline void end_frame()
+        {
+            registry::instance().end_frame();
+        }
+    }
+}
+
+#else
+
+#define EXAMPLE_PROFILE_SCOPE(name) static_cast<void>(0)
+#define EXAMPLE_PROFILE_END_FRAME() static_cast<void>(0)
+
+#endif
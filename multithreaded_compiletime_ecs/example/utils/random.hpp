@@ -0,0 +1,50 @@
+// Copyright (c) 2015-2016 Vittorio Romeo
+// License: Academic Free License ("AFL") v. 3.0
+// AFL License page: http://opensource.org/licenses/AFL-3.0
+// http://vittorioromeo.info | vittorio.romeo@outlook.com
+
+#pragma once
+
+#include <cstdint>
+#include <random>
+
+// Seedable random number generation, so that simulations (and benchmarks)
+// can be reproduced exactly. Not thread-safe: only meant to be used outside
+// of system execution, e.g. while initializing a context.
+
+namespace example
+{
+    inline auto& random_engine() noexcept
+    {
+        static std::mt19937 engine;
+        return engine;
+    }
+
+    inline void seed_random(std::uint32_t seed) noexcept
+    {
+        random_engine().seed(seed);
+    }
+
+    // Returns a random float in `[min, max)`.
+    inline float random_float(float min, float max)
+    {
+        return std::uniform_real_distribution<float>{min, max}(
+            random_engine());
+    }
+
+    // Returns a random integer in `[0, n)`. Requires `n > 0`.
+    template <typename T>
+    inline T random_index(T n)
+    {
+        return std::uniform_int_distribution<T>{0, n - 1}(random_engine());
+    }
+
+    // Returns a 2D vector with random components in `[min, max)`.
+    template <typename TVec2>
+    inline auto random_vec2(float min, float max)
+    {
+        auto x = random_float(min, max);
+        auto y = random_float(min, max);
+        return TVec2{x, y};
+    }
+}
@@ -0,0 +1,236 @@
+// Copyright (c) 2015-2016 Vittorio Romeo
+// License: Academic Free License ("AFL") v. 3.0
+// AFL License page: http://opensource.org/licenses/AFL-3.0
+// http://vittorioromeo.info | vittorio.romeo@outlook.com
+
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <iterator>
+#include <vector>
+#include "./work_stealing.hpp"
+
+// System outputs made of append-only segments, and a flat view over them.
+
+// A `segmented_output` is the output of a subtask (`ss::output::data<...>`)
+// split in independent segments: every segment is appended to by a single
+// thread at a time, so that the blocks of a work-stealing subtask can write
+// their results concurrently without locks, and without being concatenated
+// afterwards. Segments keep their capacity across frames.
+
+// A `segmented_view` references the segments of any number of outputs, in
+// the order they are added, as a single sequence with a size and random
+// access. Nothing is copied: the view is only valid until the outputs are
+// written again.
+
+namespace example
+{
+    template <typename T>
+    class segmented_output
+    {
+    private:
+        std::vector<std::vector<T>> _segments;
+        std::size_t _used{0};
+
+    public:
+        // Replaces the contents with `n` empty segments.
+        void reset(std::size_t n)
+        {
+            if(_segments.size() < n) _segments.resize(n);
+
+            for(std::size_t i = 0; i < n; ++i)
+            {
+                _segments[i].clear();
+            }
+
+            _used = n;
+        }
+
+        auto segment_count() const noexcept
+        {
+            return _used;
+        }
+
+        auto& segment(std::size_t i) noexcept
+        {
+            assert(i < _used);
+            return _segments[i];
+        }
+
+        const auto& segment(std::size_t i) const noexcept
+        {
+            assert(i < _used);
+            return _segments[i];
+        }
+    };
+
+    template <typename T>
+    class segmented_view
+    {
+    private:
+        struct span
+        {
+            const T* _data;
+            std::size_t _size;
+        };
+
+        std::vector<span> _spans;
+
+        // `_offsets[i]` is the index of the first item of span `i`.
+        std::vector<std::size_t> _offsets{0};
+
+    public:
+        class iterator
+        {
+        private:
+            const segmented_view* _view;
+            std::size_t _span;
+            std::size_t _i;
+
+        public:
+            using iterator_category = std::forward_iterator_tag;
+            using value_type = T;
+            using difference_type = std::ptrdiff_t;
+            using pointer = const T*;
+            using reference = const T&;
+
+            iterator(const segmented_view* v, std::size_t s) noexcept
+                : _view{v}, _span{s}, _i{0}
+            {
+            }
+
+            auto& operator*() const noexcept
+            {
+                return _view->_spans[_span]._data[_i];
+            }
+
+            auto operator-> () const noexcept
+            {
+                return &**this;
+            }
+
+            auto& operator++() noexcept
+            {
+                if(++_i == _view->_spans[_span]._size)
+                {
+                    ++_span;
+                    _i = 0;
+                }
+
+                return *this;
+            }
+
+            auto operator++(int) noexcept
+            {
+                auto result = *this;
+                ++*this;
+                return result;
+            }
+
+            bool operator==(const iterator& rhs) const noexcept
+            {
+                return _span == rhs._span && _i == rhs._i;
+            }
+
+            bool operator!=(const iterator& rhs) const noexcept
+            {
+                return !(*this == rhs);
+            }
+        };
+
+        void clear() noexcept
+        {
+            _spans.clear();
+            _offsets.resize(1);
+        }
+
+        // Appends the non-empty segments of `o` to the view.
+        void add(const segmented_output<T>& o)
+        {
+            for(std::size_t i = 0; i < o.segment_count(); ++i)
+            {
+                const auto& s = o.segment(i);
+                if(s.empty()) continue;
+
+                _spans.emplace_back(span{s.data(), s.size()});
+                _offsets.emplace_back(_offsets.back() + s.size());
+            }
+        }
+
+        auto size() const noexcept
+        {
+            return _offsets.back();
+        }
+
+        auto empty() const noexcept
+        {
+            return size() == 0;
+        }
+
+        // Logarithmic in the number of segments.
+        const auto& operator[](std::size_t i) const noexcept
+        {
+            assert(i < size());
+
+            const auto it =
+                std::upper_bound(_offsets.begin(), _offsets.end(), i);
+
+            const auto s = static_cast<std::size_t>(it - _offsets.begin()) - 1;
+            return _spans[s]._data[i - _offsets[s]];
+        }
+
+        auto begin() const noexcept
+        {
+            return iterator{this, 0};
+        }
+
+        auto end() const noexcept
+        {
+            return iterator{this, _spans.size()};
+        }
+
+        // Copies the items to `out`, sorted by `cmp`. Uses `pool` to sort
+        // every segment, then to merge pairs of adjacent sorted ranges. The
+        // result does not depend on the number of threads.
+        template <typename TCmp>
+        void sort_into(
+            work_stealing_pool& pool, std::vector<T>& out, TCmp cmp) const
+        {
+            out.resize(size());
+
+            const auto n = _spans.size();
+            pool.parallel_for(n, 1, [this, &out, &cmp](auto b, auto e)
+                {
+                    for(auto i = b; i < e; ++i)
+                    {
+                        const auto& s = _spans[i];
+                        auto first = out.begin() + _offsets[i];
+
+                        std::copy(s._data, s._data + s._size, first);
+                        std::sort(first, first + s._size, cmp);
+                    }
+                });
+
+            for(std::size_t w = 1; w < n; w *= 2)
+            {
+                const auto pairs = (n + w * 2 - 1) / (w * 2);
+                pool.parallel_for(pairs, 1, [this, w, n, &out, &cmp](
+                                                auto b, auto e)
+                    {
+                        for(auto p = b; p < e; ++p)
+                        {
+                            const auto first = p * w * 2;
+                            const auto middle = std::min(first + w, n);
+                            const auto last = std::min(first + w * 2, n);
+
+                            std::inplace_merge(out.begin() + _offsets[first],
+                                out.begin() + _offsets[middle],
+                                out.begin() + _offsets[last], cmp);
+                        }
+                    });
+            }
+        }
+    };
+}
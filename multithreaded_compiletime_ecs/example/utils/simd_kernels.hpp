@@ -0,0 +1,147 @@
+// Copyright (c) 2015-2016 Vittorio Romeo
+// License: Academic Free License ("AFL") v. 3.0
+// AFL License page: http://opensource.org/licenses/AFL-3.0
+// http://vittorioromeo.info | vittorio.romeo@outlook.com
+
+#pragma once
+
+#include <cstddef>
+#include <type_traits>
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+// Streaming kernels used by the integration systems. Every kernel works on
+// flat arrays of `float`, where a 2D vector component is stored as two
+// consecutive floats: `n` is always the number of *particles*.
+
+namespace example
+{
+    namespace simd
+    {
+        using sz_t = std::size_t;
+
+        // Views an array of components wrapping float vectors as a flat
+        // array of floats.
+        template <typename T>
+        auto as_floats(T* p) noexcept
+        {
+            static_assert(std::is_standard_layout<T>{}, "");
+            static_assert(sizeof(T) % sizeof(float) == 0, "");
+
+            using float_type = std::conditional_t<std::is_const<T>{},
+                const float, float>;
+
+            return reinterpret_cast<float_type*>(p);
+        }
+
+        // `y[i] += x[i] * k` on `n` 2D vectors.
+        // Processes 8 particles (16 floats) per step.
+        inline void multiply_add(
+            float* y, const float* x, float k, sz_t n) noexcept
+        {
+            const sz_t n_floats = n * 2;
+            sz_t i = 0;
+
+#if defined(__AVX__)
+            const auto vk = _mm256_set1_ps(k);
+            for(; i + 16 <= n_floats; i += 16)
+            {
+                auto y0 = _mm256_loadu_ps(y + i);
+                auto y1 = _mm256_loadu_ps(y + i + 8);
+                auto x0 = _mm256_loadu_ps(x + i);
+                auto x1 = _mm256_loadu_ps(x + i + 8);
+
+                y0 = _mm256_add_ps(y0, _mm256_mul_ps(x0, vk));
+                y1 = _mm256_add_ps(y1, _mm256_mul_ps(x1, vk));
+
+                _mm256_storeu_ps(y + i, y0);
+                _mm256_storeu_ps(y + i + 8, y1);
+            }
+#elif defined(__SSE2__)
+            const auto vk = _mm_set1_ps(k);
+            for(; i + 16 <= n_floats; i += 16)
+            {
+                for(sz_t j = 0; j < 16; j += 4)
+                {
+                    auto vy = _mm_loadu_ps(y + i + j);
+                    auto vx = _mm_loadu_ps(x + i + j);
+
+                    vy = _mm_add_ps(vy, _mm_mul_ps(vx, vk));
+                    _mm_storeu_ps(y + i + j, vy);
+                }
+            }
+#endif
+
+            // Scalar tail.
+            for(; i < n_floats; ++i)
+            {
+                y[i] += x[i] * k;
+            }
+        }
+
+        // Axis-aligned bounds of the simulation.
+        struct bounds
+        {
+            float _left, _top, _right, _bottom;
+        };
+
+        // Clamps `n` circles (positions `p`, radii `r`) inside `b`, inverting
+        // the velocity `v` along every axis where the circle was outside.
+        // Branchless: the clamp is a min/max pair and the inversion is a
+        // masked sign flip.
+        inline void reflect_in_bounds(float* p, float* v, const float* r,
+            sz_t n, const bounds& b) noexcept
+        {
+            sz_t i = 0;
+
+#if defined(__SSE2__)
+            // Two particles per register: `(x0, y0, x1, y1)`.
+            const auto vmin = _mm_setr_ps(b._left, b._top, b._left, b._top);
+            const auto vmax =
+                _mm_setr_ps(b._right, b._bottom, b._right, b._bottom);
+            const auto sign = _mm_set1_ps(-0.f);
+
+            for(; i + 2 <= n; i += 2)
+            {
+                // `(r0, r0, r1, r1)`.
+                auto vr = _mm_setr_ps(r[i], r[i], r[i + 1], r[i + 1]);
+
+                auto lo = _mm_add_ps(vmin, vr);
+                auto hi = _mm_sub_ps(vmax, vr);
+
+                auto vp = _mm_loadu_ps(p + i * 2);
+                auto vv = _mm_loadu_ps(v + i * 2);
+
+                auto out =
+                    _mm_or_ps(_mm_cmplt_ps(vp, lo), _mm_cmpgt_ps(vp, hi));
+
+                vp = _mm_min_ps(_mm_max_ps(vp, lo), hi);
+                vv = _mm_xor_ps(vv, _mm_and_ps(out, sign));
+
+                _mm_storeu_ps(p + i * 2, vp);
+                _mm_storeu_ps(v + i * 2, vv);
+            }
+#endif
+
+            // Scalar tail.
+            for(; i < n; ++i)
+            {
+                const float lo[] = {b._left + r[i], b._top + r[i]};
+                const float hi[] = {b._right - r[i], b._bottom - r[i]};
+
+                for(sz_t k = 0; k < 2; ++k)
+                {
+                    auto& x = p[i * 2 + k];
+                    auto flip = (x < lo[k]) | (x > hi[k]);
+
+                    x = x < lo[k] ? lo[k] : (x > hi[k] ? hi[k] : x);
+                    v[i * 2 + k] *= flip ? -1.f : 1.f;
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,467 @@
+// Copyright (c) 2015-2016 Vittorio Romeo
+// License: Academic Free License ("AFL") v. 3.0
+// AFL License page: http://opensource.org/licenses/AFL-3.0
+// http://vittorioromeo.info | vittorio.romeo@outlook.com
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+
+// Compile-time analysis of the dependency graph of a system signature list.
+
+// Every system is described by the systems it depends on and by the
+// resources it reads and mutates, as bitmasks. Resources are components, but
+// also anything else shared between systems: the state of a system accessed
+// through `data.system(...)`, or its outputs accessed through
+// `data.for_previous_outputs(...)`.
+/*
+    constexpr auto g = graph::make_system_graph(
+        graph::node{"a", graph::bits(), graph::bits(), graph::bits(0)},
+        graph::node{"b", graph::bits(0), graph::bits(0), graph::bits()});
+
+    static_assert(g.unordered_conflicts() == 0, "");
+    static_assert(g.width() == 1, "");
+*/
+
+// Two systems conflict when one of them mutates a resource the other one
+// reads or mutates: they must be ordered by a chain of dependencies. A
+// dependency is:
+// * "Redundant", if it is implied by the other dependencies of the system
+//   (i.e. it is not part of the transitive reduction of the graph).
+// * "Unjustified", if removing it leaves every conflicting pair ordered.
+//   Redundant dependencies are always unjustified.
+
+// Levels are assigned "as soon as possible": a system's level is the length
+// of the longest dependency chain leading to it. Every level only depends on
+// the previous ones, so the number of systems of the most populated level is
+// the maximum parallel width of the schedule, and the number of levels is the
+// length of the critical path.
+
+namespace example
+{
+    namespace graph
+    {
+        using mask = std::uint64_t;
+
+        // Maximum number of systems and resources.
+        constexpr std::size_t max_bits = 64;
+
+        // Mask with the bits at the indices `xs...` set.
+        template <typename... Ts>
+        constexpr mask bits(Ts... xs) noexcept
+        {
+            mask result = 0;
+
+            using swallow = int[];
+            (void)swallow{0, (result |= mask(1) << xs, 0)...};
+
+            return result;
+        }
+
+        constexpr bool has(mask m, std::size_t i) noexcept
+        {
+            return (m & (mask(1) << i)) != 0;
+        }
+
+        struct node
+        {
+            const char* _name;
+            mask _deps;
+            mask _reads;
+            mask _mutates;
+        };
+
+        template <std::size_t TN>
+        class system_graph
+        {
+            static_assert(TN > 0 && TN <= max_bits, "");
+
+        private:
+            node _nodes[TN];
+
+            // One mask per system.
+            struct masks
+            {
+                mask _v[TN];
+            };
+
+            // Ancestors of every system, ignoring the dependency of `skip_n`
+            // on `skip_d` (if any).
+            constexpr masks ancestors_without(
+                std::size_t skip_n, std::size_t skip_d) const noexcept
+            {
+                masks result{};
+                for(std::size_t i = 0; i < TN; ++i)
+                {
+                    result._v[i] = _nodes[i]._deps;
+                }
+
+                if(skip_n < TN)
+                {
+                    result._v[skip_n] &= ~(mask(1) << skip_d);
+                }
+
+                // The longest chain has `TN - 1` dependencies.
+                for(std::size_t k = 0; k < TN; ++k)
+                {
+                    for(std::size_t i = 0; i < TN; ++i)
+                    {
+                        auto acc = result._v[i];
+                        for(std::size_t d = 0; d < TN; ++d)
+                        {
+                            if(has(result._v[i], d)) acc |= result._v[d];
+                        }
+
+                        result._v[i] = acc;
+                    }
+                }
+
+                return result;
+            }
+
+            constexpr masks ancestors() const noexcept
+            {
+                return ancestors_without(TN, 0);
+            }
+
+            // Number of conflicting pairs that are not ordered by `anc`.
+            constexpr std::size_t unordered_conflicts(
+                const masks& anc) const noexcept
+            {
+                std::size_t result = 0;
+                for(std::size_t i = 0; i < TN; ++i)
+                {
+                    for(std::size_t j = i + 1; j < TN; ++j)
+                    {
+                        if(conflicts(i, j) && !has(anc._v[i], j) &&
+                            !has(anc._v[j], i))
+                        {
+                            ++result;
+                        }
+                    }
+                }
+
+                return result;
+            }
+
+        public:
+            template <typename... TNodes>
+            constexpr system_graph(const TNodes&... nodes) noexcept
+                : _nodes{nodes...}
+            {
+            }
+
+            static constexpr std::size_t size() noexcept
+            {
+                return TN;
+            }
+
+            constexpr const node& at(std::size_t i) const noexcept
+            {
+                return _nodes[i];
+            }
+
+            // Resources that make systems `i` and `j` conflict.
+            constexpr mask conflicting_resources(
+                std::size_t i, std::size_t j) const noexcept
+            {
+                const auto& a = _nodes[i];
+                const auto& b = _nodes[j];
+
+                return (a._mutates & (b._reads | b._mutates)) |
+                       (b._mutates & a._reads);
+            }
+
+            constexpr bool conflicts(std::size_t i, std::size_t j) const
+                noexcept
+            {
+                return conflicting_resources(i, j) != 0;
+            }
+
+            constexpr bool acyclic() const noexcept
+            {
+                const auto anc = ancestors();
+                for(std::size_t i = 0; i < TN; ++i)
+                {
+                    if(has(anc._v[i], i)) return false;
+                }
+
+                return true;
+            }
+
+            // Whether system `i` (transitively) depends on system `j`.
+            constexpr bool depends_on(std::size_t i, std::size_t j) const
+                noexcept
+            {
+                return has(ancestors()._v[i], j);
+            }
+
+            // Dependencies of system `i` implied by its other dependencies.
+            constexpr mask redundant_deps(std::size_t i) const noexcept
+            {
+                const auto anc = ancestors();
+                const auto deps = _nodes[i]._deps;
+
+                mask implied = 0;
+                for(std::size_t d = 0; d < TN; ++d)
+                {
+                    if(has(deps, d)) implied |= anc._v[d];
+                }
+
+                return deps & implied;
+            }
+
+            // Dependencies of system `i` not required to order any
+            // conflicting pair.
+            constexpr mask unjustified_deps(std::size_t i) const noexcept
+            {
+                const auto before = unordered_conflicts(ancestors());
+
+                mask result = 0;
+                for(std::size_t d = 0; d < TN; ++d)
+                {
+                    if(has(_nodes[i]._deps, d) &&
+                        unordered_conflicts(ancestors_without(i, d)) == before)
+                    {
+                        result |= mask(1) << d;
+                    }
+                }
+
+                return result;
+            }
+
+            // Number of dependencies over the whole graph.
+            constexpr std::size_t dependency_count() const noexcept
+            {
+                std::size_t result = 0;
+                for(std::size_t i = 0; i < TN; ++i)
+                {
+                    for(std::size_t d = 0; d < TN; ++d)
+                    {
+                        if(has(_nodes[i]._deps, d)) ++result;
+                    }
+                }
+
+                return result;
+            }
+
+            constexpr std::size_t unjustified_dependency_count() const
+                noexcept
+            {
+                std::size_t result = 0;
+                for(std::size_t i = 0; i < TN; ++i)
+                {
+                    for(std::size_t d = 0; d < TN; ++d)
+                    {
+                        if(has(unjustified_deps(i), d)) ++result;
+                    }
+                }
+
+                return result;
+            }
+
+            // Number of conflicting pairs not ordered by any chain of
+            // dependencies: every one of them is a data race.
+            constexpr std::size_t unordered_conflicts() const noexcept
+            {
+                return unordered_conflicts(ancestors());
+            }
+
+            // Level of system `i`. Requires an acyclic graph.
+            constexpr std::size_t level(std::size_t i) const noexcept
+            {
+                std::size_t levels[TN]{};
+
+                for(std::size_t k = 0; k < TN; ++k)
+                {
+                    for(std::size_t j = 0; j < TN; ++j)
+                    {
+                        for(std::size_t d = 0; d < TN; ++d)
+                        {
+                            if(has(_nodes[j]._deps, d) &&
+                                levels[j] < levels[d] + 1)
+                            {
+                                levels[j] = levels[d] + 1;
+                            }
+                        }
+                    }
+                }
+
+                return levels[i];
+            }
+
+            // Number of levels, which is also the number of systems on the
+            // critical path.
+            constexpr std::size_t level_count() const noexcept
+            {
+                std::size_t result = 0;
+                for(std::size_t i = 0; i < TN; ++i)
+                {
+                    if(result < level(i) + 1) result = level(i) + 1;
+                }
+
+                return result;
+            }
+
+            // Systems of level `l`.
+            constexpr mask systems_at_level(std::size_t l) const noexcept
+            {
+                mask result = 0;
+                for(std::size_t i = 0; i < TN; ++i)
+                {
+                    if(level(i) == l) result |= mask(1) << i;
+                }
+
+                return result;
+            }
+
+            // Maximum number of systems of the same level.
+            constexpr std::size_t width() const noexcept
+            {
+                std::size_t result = 0;
+                for(std::size_t l = 0; l < level_count(); ++l)
+                {
+                    std::size_t n = 0;
+                    for(std::size_t i = 0; i < TN; ++i)
+                    {
+                        if(has(systems_at_level(l), i)) ++n;
+                    }
+
+                    if(result < n) result = n;
+                }
+
+                return result;
+            }
+
+            // Systems of one of the longest dependency chains.
+            constexpr mask critical_path() const noexcept
+            {
+                auto last = TN;
+                for(std::size_t i = 0; i < TN && last == TN; ++i)
+                {
+                    if(level(i) + 1 == level_count()) last = i;
+                }
+
+                mask result = mask(1) << last;
+                for(auto i = last; level(i) > 0;)
+                {
+                    auto next = TN;
+                    for(std::size_t d = 0; d < TN && next == TN; ++d)
+                    {
+                        if(has(_nodes[i]._deps, d) &&
+                            level(d) + 1 == level(i))
+                        {
+                            next = d;
+                        }
+                    }
+
+                    i = next;
+                    result |= mask(1) << i;
+                }
+
+                return result;
+            }
+        };
+
+        template <typename... TNodes>
+        constexpr auto make_system_graph(const TNodes&... nodes) noexcept
+        {
+            return system_graph<sizeof...(TNodes)>{nodes...};
+        }
+
+        namespace impl
+        {
+            // Prints the names of the elements of `m`, separated by `sep`.
+            template <typename TF>
+            void write_names(std::ostream& os, mask m, const char* sep, TF&& f)
+            {
+                const char* s = "";
+                for(std::size_t i = 0; i < max_bits; ++i)
+                {
+                    if(!has(m, i)) continue;
+
+                    os << s << f(i);
+                    s = sep;
+                }
+            }
+        }
+
+        // Prints the levels, the critical path and the dependencies of `g`,
+        // with the conflicting resources that justify every dependency.
+        // `resource_names[i]` is the name of the resource with index `i`.
+        template <std::size_t TN, std::size_t TR>
+        void write_schedule_report(std::ostream& os,
+            const system_graph<TN>& g, const char* const (&resource_names)[TR])
+        {
+            auto system_name = [&g](auto i)
+            {
+                return g.at(i)._name;
+            };
+
+            auto resource_name = [&resource_names](auto i)
+            {
+                return i < TR ? resource_names[i] : "?";
+            };
+
+            os << "System schedule: " << TN << " systems, "
+               << g.dependency_count() << " dependencies\n";
+
+            if(!g.acyclic())
+            {
+                os << "  the dependency graph has cycles\n";
+                return;
+            }
+
+            os << "  critical path (length " << g.level_count() << "): ";
+            impl::write_names(os, g.critical_path(), " -> ", system_name);
+
+            os << "\n  maximum parallel width: " << g.width() << "\n";
+            os << "  levels:\n";
+
+            for(std::size_t l = 0; l < g.level_count(); ++l)
+            {
+                os << "    " << l << ": ";
+                impl::write_names(os, g.systems_at_level(l), ", ", system_name);
+                os << "\n";
+            }
+
+            os << "  dependencies:\n";
+
+            for(std::size_t i = 0; i < TN; ++i)
+            {
+                for(std::size_t d = 0; d < TN; ++d)
+                {
+                    if(!has(g.at(i)._deps, d)) continue;
+
+                    os << "    " << g.at(i)._name << " <- " << g.at(d)._name
+                       << ": ";
+
+                    if(has(g.redundant_deps(i), d))
+                    {
+                        os << "redundant";
+                    }
+                    else if(has(g.unjustified_deps(i), d))
+                    {
+                        os << "unjustified";
+                    }
+                    else if(g.conflicts(i, d))
+                    {
+                        impl::write_names(os, g.conflicting_resources(i, d),
+                            ", ", resource_name);
+                    }
+                    else
+                    {
+                        os << "transitive";
+                    }
+
+                    os << "\n";
+                }
+            }
+
+            os << "  unordered conflicts: " << g.unordered_conflicts()
+               << "\n";
+        }
+    }
+}
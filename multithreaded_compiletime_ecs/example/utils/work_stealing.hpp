@@ -0,0 +1,356 @@
+// Copyright (c) 2015-2016 Vittorio Romeo
+// License: Academic Free License ("AFL") v. 3.0
+// AFL License page: http://opensource.org/licenses/AFL-3.0
+// http://vittorioromeo.info | vittorio.romeo@outlook.com
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+// Work-stealing thread pool, used to split the entities of systems with
+// uneven per-entity cost adaptively instead of in fixed even slices.
+
+// `parallel_for(n, grain, f)` splits the `[0, n)` range in one contiguous
+// slice per thread, and pushes every slice in the queue of its thread. As
+// long as `n` does not change, every thread starts from the same indices at
+// every call, so it keeps touching the same memory. A worker repeatedly
+// splits the range it is processing in half, pushing the right half to the
+// bottom of its own queue, until it is at most `grain` long. Idle workers
+// steal the largest pending ranges from the top of the other queues.
+
+// With `thread_affinity::none`, the calling thread takes part in the
+// execution and owns the first slice. With `thread_affinity::pinned`, every
+// slice is owned by a worker bound to one of the CPUs the process is allowed
+// to run on (Linux only), so that the slices do not move between cores, or
+// sockets, from one call to the next. The calling thread, which can run
+// anywhere, only waits for the workers.
+
+// Split points are always multiples of `grain`: the leaf ranges passed to
+// `f` are exactly the blocks `[k * grain, (k + 1) * grain)`, regardless of
+// how the work was stolen. Block-indexed outputs are therefore deterministic.
+
+namespace example
+{
+    // Placement of the worker threads of a `work_stealing_pool`.
+    enum class thread_affinity
+    {
+        // Workers are scheduled by the OS.
+        none,
+
+        // Worker `i`, which owns slice `i`, is bound to the `i`-th allowed
+        // CPU (modulo their count). The calling thread does not process any
+        // block.
+        pinned
+    };
+
+    class work_stealing_pool
+    {
+    private:
+        struct range
+        {
+            std::size_t _begin, _end;
+        };
+
+        struct queue
+        {
+            std::mutex _mutex;
+            std::deque<range> _ranges;
+        };
+
+        using job_fn_type = void (*)(const void*, std::size_t, std::size_t);
+
+        std::size_t _worker_count;
+        thread_affinity _affinity;
+        std::unique_ptr<queue[]> _queues;
+        std::vector<std::thread> _threads;
+
+        // Serializes concurrent `parallel_for` calls.
+        std::mutex _run_mutex;
+
+        // Wakes up the workers when a new job is available.
+        std::mutex _job_mutex;
+        std::condition_variable _job_cv;
+        std::size_t _epoch{0};
+        bool _stop{false};
+
+        // Current job. Published to the workers through the queue mutexes.
+        const void* _job_ctx{nullptr};
+        job_fn_type _job_fn{nullptr};
+        std::size_t _grain{1};
+        std::atomic<std::size_t> _remaining{0};
+
+        // Wakes up a calling thread that does not participate when the last
+        // block of the job is complete.
+        std::mutex _done_mutex;
+        std::condition_variable _done_cv;
+
+        bool caller_participates() const noexcept
+        {
+            return _affinity == thread_affinity::none;
+        }
+
+        void push(std::size_t i, range r)
+        {
+            std::lock_guard<std::mutex> lock{_queues[i]._mutex};
+            _queues[i]._ranges.emplace_back(r);
+        }
+
+        // Pops from the bottom of the own queue (most recently split range).
+        bool pop(std::size_t i, range& r)
+        {
+            std::lock_guard<std::mutex> lock{_queues[i]._mutex};
+            auto& q = _queues[i]._ranges;
+            if(q.empty()) return false;
+
+            r = q.back();
+            q.pop_back();
+            return true;
+        }
+
+        // Steals from the top of another queue (largest pending range).
+        bool steal(std::size_t i, range& r)
+        {
+            for(std::size_t k = 1; k < _worker_count; ++k)
+            {
+                auto& victim = _queues[(i + k) % _worker_count];
+
+                std::lock_guard<std::mutex> lock{victim._mutex};
+                if(victim._ranges.empty()) continue;
+
+                r = victim._ranges.front();
+                victim._ranges.pop_front();
+                return true;
+            }
+
+            return false;
+        }
+
+        void execute(std::size_t i, range r)
+        {
+            while(r._end - r._begin > _grain)
+            {
+                // Smallest multiple of `_grain` covering half of the range.
+                const auto half = (r._end - r._begin) / 2;
+                const auto mid =
+                    r._begin + (half + _grain - 1) / _grain * _grain;
+
+                push(i, range{mid, r._end});
+                r._end = mid;
+            }
+
+            _job_fn(_job_ctx, r._begin, r._end);
+
+            const auto count = r._end - r._begin;
+            if(_remaining.fetch_sub(count, std::memory_order_acq_rel) == count)
+            {
+                std::lock_guard<std::mutex> lock{_done_mutex};
+                _done_cv.notify_all();
+            }
+        }
+
+        void participate(std::size_t i)
+        {
+            range r;
+            while(_remaining.load(std::memory_order_acquire) != 0)
+            {
+                if(pop(i, r) || steal(i, r))
+                {
+                    execute(i, r);
+                }
+                else
+                {
+                    std::this_thread::yield();
+                }
+            }
+        }
+
+#if defined(__linux__)
+        // Binds `thread` to the `i`-th CPU (modulo their count) of the
+        // affinity mask of the calling thread. Does nothing on failure.
+        static void pin_thread(pthread_t thread, std::size_t i) noexcept
+        {
+            cpu_set_t allowed;
+            if(sched_getaffinity(0, sizeof(allowed), &allowed) != 0) return;
+
+            const auto count = static_cast<std::size_t>(CPU_COUNT(&allowed));
+            if(count == 0) return;
+
+            auto k = i % count;
+            for(int cpu = 0; cpu < CPU_SETSIZE; ++cpu)
+            {
+                if(!CPU_ISSET(cpu, &allowed) || k-- != 0) continue;
+
+                cpu_set_t set;
+                CPU_ZERO(&set);
+                CPU_SET(cpu, &set);
+                pthread_setaffinity_np(thread, sizeof(set), &set);
+                return;
+            }
+        }
+#endif
+
+        // Index of the slice owned by `_threads[t]`: with a participating
+        // calling thread, slice `0` is its own.
+        auto slice_of(std::size_t t) const noexcept
+        {
+            return caller_participates() ? t + 1 : t;
+        }
+
+        void worker_loop(std::size_t i)
+        {
+            std::size_t seen_epoch = 0;
+
+            while(true)
+            {
+                {
+                    std::unique_lock<std::mutex> lock{_job_mutex};
+                    _job_cv.wait(lock, [&]
+                        {
+                            return _stop || _epoch != seen_epoch;
+                        });
+
+                    if(_stop) return;
+                    seen_epoch = _epoch;
+                }
+
+                participate(i);
+            }
+        }
+
+    public:
+        // Creates a pool that processes blocks on `thread_count` threads.
+        // With `thread_affinity::none`, they include the thread calling
+        // `parallel_for`: `thread_count - 1` workers are spawned.
+        explicit work_stealing_pool(
+            std::size_t thread_count = std::thread::hardware_concurrency(),
+            thread_affinity affinity = thread_affinity::none)
+            : _worker_count{std::max(thread_count, std::size_t(1))},
+              _affinity{affinity},
+              _queues{std::make_unique<queue[]>(_worker_count)}
+        {
+            const auto first = caller_participates() ? 1 : 0;
+            for(std::size_t i = first; i < _worker_count; ++i)
+            {
+                _threads.emplace_back([this, i]
+                    {
+                        this->worker_loop(i);
+                    });
+            }
+
+            pin_workers();
+        }
+
+        work_stealing_pool(const work_stealing_pool&) = delete;
+        work_stealing_pool& operator=(const work_stealing_pool&) = delete;
+
+        ~work_stealing_pool()
+        {
+            {
+                std::lock_guard<std::mutex> lock{_job_mutex};
+                _stop = true;
+            }
+
+            _job_cv.notify_all();
+            for(auto& t : _threads) t.join();
+        }
+
+        auto thread_count() const noexcept
+        {
+            return _worker_count;
+        }
+
+        // With `thread_affinity::pinned`, binds every worker again from the
+        // current affinity mask of the calling thread. Has to be called after
+        // anything that replaces the affinity of the workers (such as
+        // `sched_setaffinity` on every thread of the process).
+        void pin_workers() noexcept
+        {
+#if defined(__linux__)
+            if(_affinity != thread_affinity::pinned) return;
+
+            for(std::size_t t = 0; t < _threads.size(); ++t)
+            {
+                pin_thread(_threads[t].native_handle(), slice_of(t));
+            }
+#endif
+        }
+
+        // Executes `f(begin, end)` on blocks of `grain` indices covering
+        // `[0, n)`, and returns when all of them have been processed.
+        template <typename TF>
+        void parallel_for(std::size_t n, std::size_t grain, const TF& f)
+        {
+            if(n == 0) return;
+
+            std::lock_guard<std::mutex> run_lock{_run_mutex};
+
+            _job_ctx = &f;
+            _job_fn = [](const void* ctx, std::size_t b, std::size_t e)
+            {
+                (*static_cast<const TF*>(ctx))(b, e);
+            };
+
+            _grain = std::max(grain, std::size_t(1));
+            _remaining = n;
+
+            // Slice `i` covers the blocks `[i * b / w, (i + 1) * b / w)`.
+            const auto blocks = (n + _grain - 1) / _grain;
+            for(std::size_t i = 0; i < _worker_count; ++i)
+            {
+                const auto b = i * blocks / _worker_count * _grain;
+                const auto e = std::min(
+                    (i + 1) * blocks / _worker_count * _grain, n);
+
+                if(b < e) push(i, range{b, e});
+            }
+
+            {
+                std::lock_guard<std::mutex> lock{_job_mutex};
+                ++_epoch;
+            }
+
+            _job_cv.notify_all();
+
+            if(caller_participates())
+            {
+                participate(0);
+                return;
+            }
+
+            std::unique_lock<std::mutex> lock{_done_mutex};
+            _done_cv.wait(lock, [this]
+                {
+                    return _remaining.load(std::memory_order_acquire) == 0;
+                });
+        }
+    };
+
+    // Pool shared by the systems scheduled with `sched::s_work_stealing`.
+    // Define `EXAMPLE_PIN_WORKERS` to pin its workers.
+    inline auto& default_work_stealing_pool()
+    {
+#if defined(EXAMPLE_PIN_WORKERS)
+        constexpr auto affinity = thread_affinity::pinned;
+#else
+        constexpr auto affinity = thread_affinity::none;
+#endif
+
+        static work_stealing_pool pool{
+            std::thread::hardware_concurrency(), affinity};
+
+        return pool;
+    }
+}
@@ -0,0 +1,124 @@
+#!/bin/bash
+
+# Checks that the constructs in `./cases.txt` are "cost-free abstractions":
+# every candidate source has to compile to the same instruction stream as
+# its reference source, for every optimization level starting from the one
+# specified for the compiler.
+
+# Usage:
+#   ./check.sh [compiler...]   Compiles the cases (default: g++ clang++).
+#   ./check.sh --listings      Compares the checked-in `./gcc/*.s` and
+#                              `./clang/*.s` listings instead.
+
+# The listings are normalized before being compared: directives, comments
+# and function boundary labels are removed, and local labels and mangled
+# symbol names are renamed in order of appearance.
+# Differences are printed as a `diff` of the normalized listings, and the
+# script fails if any case differs.
+
+root=$(cd "$(dirname "$0")" && pwd)
+work=$(mktemp -d)
+trap 'rm -rf "$work"' EXIT
+
+normalize()
+{
+    awk '
+        function rename(s, re, prefix, names,    out, m)
+        {
+            out = ""
+            while(match(s, re))
+            {
+                m = substr(s, RSTART, RLENGTH)
+                if(!(m in names)) names[m] = prefix (++names[""])
+                out = out substr(s, 1, RSTART - 1) names[m]
+                s = substr(s, RSTART + RLENGTH)
+            }
+            return out s
+        }
+
+        {
+            sub(/[ \t]*#.*/, "")
+        }
+
+        /^[ \t]*\./ || /^\.LF[BE][0-9]+:/ || /^[ \t]*$/ { next }
+
+        {
+            $0 = rename($0, "\\.L[A-Za-z_]*[0-9]+", "L", labels)
+            $0 = rename($0, "_Z[A-Za-z0-9_]+", "S", symbols)
+            gsub(/[ \t]+/, " ")
+            print
+        }
+    ' "$1"
+}
+
+# Prints the cases as `reference candidate level`, for compiler column `$1`.
+for_cases()
+{
+    grep -v '^\s*#' "$root/cases.txt" | awk -v c=$1 'NF { print $1, $2, $c }'
+}
+
+# Compares the listings `$1` and `$2`, reporting the result as `$3`.
+compare()
+{
+    normalize "$1" > "$work/a"
+    normalize "$2" > "$work/b"
+
+    if diff "$work/a" "$work/b" > "$work/diff"; then
+        echo "ok:   $3"
+        return 0
+    fi
+
+    echo "FAIL: $3"
+    sed 's/^/    /' "$work/diff"
+    return 1
+}
+
+failed=0
+
+if [ "$1" == "--listings" ]; then
+    column=3
+    for dir in gcc clang; do
+        while read -r reference candidate level; do
+            for ((o = level; o <= 3; ++o)); do
+                a="$root/$dir/${reference%.cpp}_O$o.s"
+                b="$root/$dir/${candidate%.cpp}_O$o.s"
+                [ -f "$a" ] && [ -f "$b" ] || continue
+
+                compare "$a" "$b" "$dir: $candidate -O$o" || failed=1
+            done
+        done < <(for_cases $column)
+        column=4
+    done
+
+    exit $failed
+fi
+
+compilers=${@:-g++ clang++}
+
+for cxx in $compilers; do
+    if ! command -v $cxx &> /dev/null; then
+        echo "skipping $cxx: not found"
+        continue
+    fi
+
+    # Match the flags of `../cer` and `../cerc`, and the compiler column.
+    case $(basename $cxx) in
+        clang*) column=4; std=c++1z ;;
+        *)      column=3; std=c++14 ;;
+    esac
+
+    while read -r reference candidate level; do
+        for ((o = level; o <= 3; ++o)); do
+            for src in $reference $candidate; do
+                $cxx -std=$std -O$o -S "$root/$src" \
+                    -o "$work/${src%.cpp}_O$o.s" || failed=1
+            done
+
+            compare "$work/${reference%.cpp}_O$o.s" \
+                "$work/${candidate%.cpp}_O$o.s" \
+                "$cxx: $candidate -O$o" || failed=1
+        done
+    done < <(for_cases $column)
+done
+
+exit $failed
@@ -0,0 +1,336 @@
+#!/bin/bash
+
+# Compile-time benchmarks of `static_if`, `static_for`, `for_args` and
+# `mp::type_list`.
+
+# Generates translation units that expand the constructs over packs of
+# 10/100/1000 `int_v<>`/`sz_v<>` values (and `static_if` chains with
+# 10/100/1000 `else_if` branches), then compiles them with `-fsyntax-only`,
+# so that the measured time is frontend time only. The `type_list` cases
+# run `at`, `index_of`, `filter`, `fold` and `unique` on lists with `n`
+# elements, comparing `impl/type_list.hpp` against recursive algorithms over
+# `std::tuple` (the latter only up to 100 elements).
+# Peak memory is measured with `/usr/bin/time`, when available. The
+# `-ftime-report` output of every case is kept in the log directory, next to
+# its `-ftime-trace` JSON file (`chrome://tracing`) with the compilers that
+# support writing one for `-fsyntax-only` (clang 16 and later).
+
+# Usage:
+#   ./ctbench.sh [-b baseline_dir] [compiler...]
+# * Compilers default to `g++` and `clang++` (the missing ones are skipped).
+# * Results are written to `./results/<compiler>.csv`, as:
+#   case,n,status,seconds,peak_kb
+# * With `-b`, results are compared against `<baseline_dir>/<compiler>.csv`
+#   and the script fails if a case got slower by more than 25% (and 0.1s),
+#   or stopped compiling. A baseline is a copy of a previous `./results`.
+# * `CTBENCH_SIZES` overrides the pack sizes (e.g. `CTBENCH_SIZES="10"`).
+
+root=$(cd "$(dirname "$0")" && pwd)
+impl="$root/../impl"
+out="$root/results"
+sizes=${CTBENCH_SIZES:-"10 100 1000"}
+baseline=""
+
+if [ "$1" == "-b" ]; then
+    baseline=$2
+    shift 2
+fi
+
+compilers=${@:-g++ clang++}
+
+work=$(mktemp -d)
+trap 'rm -rf "$work"' EXIT
+
+# Prints `x<0>, x<1>, ..., x<n-1>`.
+gen_pack()
+{
+    local x=$1 n=$2
+    for ((i = 0; i < n; ++i)); do
+        [ $i -gt 0 ] && printf ", "
+        printf "%s<%d>" "$x" "$i"
+    done
+}
+
+gen_static_for()
+{
+    local engine=$1 x=$2 n=$3
+    cat <<EOS
+#include "$impl/static_for.hpp"
+#include "$impl/static_for_log.hpp"
+
+int main()
+{
+    $engine([](auto state, auto&&)
+        {
+            return state.continue_();
+        })(int_v<0>)($(gen_pack "$x" "$n"));
+}
+EOS
+}
+
+gen_for_args()
+{
+    local x=$1 n=$2
+    cat <<EOS
+#include "$impl/for_args.hpp"
+
+int main()
+{
+    int acc = 0;
+    for_args([&acc](auto x)
+        {
+            acc += decltype(x){};
+        }, $(gen_pack "$x" "$n"));
+
+    return acc;
+}
+EOS
+}
+
+gen_type_list()
+{
+    local kind=$1 n=$2
+    local last="sz_<$(((n - 1) / 2))>"
+    local elements=$(for ((i = 0; i < n; ++i)); do
+        [ $i -gt 0 ] && printf ", "
+        printf "sz_<%d>" $((i / 2))
+    done)
+
+    cat <<EOS
+#include <tuple>
+#include "$impl/static_if.hpp"
+#include "$impl/type_list.hpp"
+
+template <typename T>
+using is_even = bool_<(T{} % 2 == 0)>;
+
+template <typename TAcc, typename T>
+using plus = sz_<TAcc{} + T{}>;
+EOS
+
+    if [ "$kind" == "mp" ]; then
+        cat <<EOS
+
+using l = mp::type_list<$elements>;
+
+using r0 = mp::at<l, $((n - 1))>;
+using r1 = mp::index_of<l, $last>;
+using r2 = mp::filter<l, is_even>;
+using r3 = mp::fold<l, sz_<0>, plus>;
+using r4 = mp::unique<l>;
+EOS
+    else
+        cat <<EOS
+
+template <typename T, typename TTuple>
+struct t_index_of;
+
+template <typename T, typename... Ts>
+struct t_index_of<T, std::tuple<T, Ts...>> : sz_<0>
+{
+};
+
+template <typename T, typename T0, typename... Ts>
+struct t_index_of<T, std::tuple<T0, Ts...>>
+    : sz_<1 + t_index_of<T, std::tuple<Ts...>>{}>
+{
+};
+
+template <typename TTuple, template <typename> class TP>
+struct t_filter;
+
+template <typename... Ts, template <typename> class TP>
+struct t_filter<std::tuple<Ts...>, TP>
+{
+    using type = decltype(std::tuple_cat(std::declval<
+        std::conditional_t<TP<Ts>{}, std::tuple<Ts>, std::tuple<>>>()...));
+};
+
+template <typename TAcc, typename TTuple>
+struct t_fold
+{
+    using type = TAcc;
+};
+
+template <typename TAcc, typename T, typename... Ts>
+struct t_fold<TAcc, std::tuple<T, Ts...>>
+    : t_fold<plus<TAcc, T>, std::tuple<Ts...>>
+{
+};
+
+template <typename TSeen, typename TTuple>
+struct t_unique
+{
+    using type = TSeen;
+};
+
+template <typename... TSeen, typename T, typename... Ts>
+struct t_unique<std::tuple<TSeen...>, std::tuple<T, Ts...>>
+    : t_unique<std::conditional_t<
+                   (t_index_of<T, std::tuple<TSeen..., T>>{} <
+                       sizeof...(TSeen)),
+                   std::tuple<TSeen...>, std::tuple<TSeen..., T>>,
+          std::tuple<Ts...>>
+{
+};
+
+using l = std::tuple<$elements>;
+
+using r0 = std::tuple_element_t<$((n - 1)), l>;
+using r1 = t_index_of<$last, l>;
+using r2 = typename t_filter<l, is_even>::type;
+using r3 = typename t_fold<sz_<0>, l>::type;
+using r4 = typename t_unique<std::tuple<>, l>::type;
+EOS
+    fi
+
+    cat <<EOS
+
+int main()
+{
+    return sizeof(r0{}) + r1{} + sizeof(r2) + r3{} + sizeof(r4);
+}
+EOS
+}
+
+gen_static_if_chain()
+{
+    local n=$1
+    printf '#include "%s/static_if.hpp"\n\n' "$impl"
+    printf 'int main()\n{\n    return static_if(bool_v<false>)\n'
+    printf '        .then([](auto) { return 0; })\n'
+    for ((i = 1; i < n; ++i)); do
+        printf '        .else_if(bool_v<false>)\n'
+        printf '        .then([](auto) { return %d; })\n' "$i"
+    done
+    printf '        .else_([](auto) { return %d; })(0);\n}\n' "$n"
+}
+
+# Succeeds if compiler `$1` writes `-ftime-trace=<file>` traces.
+supports_time_trace()
+{
+    local cxx=$1
+    rm -f "$work/probe.json"
+    echo "int main() {}" | $cxx -x c++ -fsyntax-only \
+        -ftime-trace="$work/probe.json" - &> /dev/null \
+        && [ -f "$work/probe.json" ]
+}
+
+# Compiles `$1` with compiler `$2`, logging to `$3` and writing a time trace
+# to `$4` if not empty. Prints `status,seconds,peak_kb`.
+measure()
+{
+    local src=$1 cxx=$2 log=$3 trace=$4
+    local flags="-std=c++14 -fsyntax-only -ftime-report"
+    [ -n "$trace" ] && flags="$flags -ftime-trace=$trace"
+    local mem="n/a" status="ok" seconds
+
+    local start=$(date +%s.%N)
+    if [ -x /usr/bin/time ]; then
+        /usr/bin/time -f "%M" -o "$work/mem" $cxx $flags "$src" &> "$log" \
+            || status="fail"
+        mem=$(tail -n 1 "$work/mem")
+    else
+        $cxx $flags "$src" &> "$log" || status="fail"
+    fi
+    local end=$(date +%s.%N)
+
+    seconds=$(awk "BEGIN { printf \"%.3f\", $end - $start }")
+    printf "%s,%s,%s" "$status" "$seconds" "$mem"
+}
+
+# Invokes `$1` with the name and the generator arguments of every case.
+for_cases()
+{
+    for n in $sizes; do
+        for x in int_v sz_v; do
+            $1 "static_for_$x" "$n" gen_static_for static_for "$x" "$n"
+            $1 "static_for_log_$x" "$n" gen_static_for static_for_log \
+                "$x" "$n"
+            $1 "for_args_$x" "$n" gen_for_args "$x" "$n"
+        done
+
+        $1 "static_if_chain" "$n" gen_static_if_chain "$n"
+
+        $1 "type_list_mp" "$n" gen_type_list mp "$n"
+
+        # The recursive `unique` over `std::tuple` takes about a minute with
+        # 100 elements, and exceeds the instantiation depth limit with 1000.
+        if [ "$n" -le 100 ]; then
+            $1 "type_list_tuple" "$n" gen_type_list tuple "$n"
+        fi
+    done
+}
+
+# Fails if `$1` regressed against the baseline `$2`.
+compare()
+{
+    local result=$1 base=$2 regressed=0
+
+    while IFS=, read -r name n status seconds mem; do
+        [ "$name" == "case" ] && continue
+
+        local old=$(grep "^$name,$n," "$base")
+        [ -z "$old" ] && continue
+
+        local old_status=$(echo "$old" | cut -d, -f3)
+        local old_seconds=$(echo "$old" | cut -d, -f4)
+
+        if [ "$old_status" == "ok" ] && [ "$status" != "ok" ]; then
+            echo "REGRESSION: $name/$n does not compile anymore"
+            regressed=1
+        elif awk "BEGIN { exit !($seconds > $old_seconds * 1.25 + 0.1) }"
+        then
+            echo "REGRESSION: $name/$n ${old_seconds}s -> ${seconds}s"
+            regressed=1
+        fi
+    done < "$result"
+
+    return $regressed
+}
+
+mkdir -p "$out"
+failed=0
+
+for cxx in $compilers; do
+    if ! command -v $cxx &> /dev/null; then
+        echo "skipping $cxx: not found"
+        continue
+    fi
+
+    name=$(basename $cxx)
+    result="$out/$name.csv"
+    logs="$out/$name.logs"
+    mkdir -p "$logs"
+
+    echo "case,n,status,seconds,peak_kb" > "$result"
+
+    time_trace=0
+    supports_time_trace $cxx && time_trace=1
+
+    run_case()
+    {
+        local case_name=$1 n=$2
+        shift 2
+
+        local src="$work/${case_name}_$n.cpp"
+        "$@" > "$src"
+
+        local trace=""
+        [ $time_trace -eq 1 ] && trace="$logs/${case_name}_$n.json"
+
+        local line="$case_name,$n,$(measure "$src" "$cxx" \
+            "$logs/${case_name}_$n.log" "$trace")"
+
+        echo "$name: $line"
+        echo "$line" >> "$result"
+    }
+
+    for_cases run_case
+
+    if [ -n "$baseline" ] && [ -f "$baseline/$name.csv" ]; then
+        compare "$result" "$baseline/$name.csv" || failed=1
+    fi
+done
+
+exit $failed
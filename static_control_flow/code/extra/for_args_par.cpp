@@ -0,0 +1,151 @@
+// Copyright (c) 2016 Vittorio Romeo
+// License: AFL 3.0 | https://opensource.org/licenses/AFL-3.0
+// http://vittorioromeo.info | vittorio.romeo@outlook.com
+
+#include <atomic>
+#include <cassert>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include "../impl/for_args_par.hpp"
+
+// The `buffer` struct from `p06.cpp`, with a test that produces a result.
+template <std::size_t TBytes>
+struct buffer
+{
+    std::size_t checksum() const noexcept
+    {
+        std::size_t result = 0;
+        for(std::size_t i = 0; i < TBytes; ++i)
+        {
+            result += i;
+        }
+
+        return result;
+    }
+};
+
+void test_results()
+{
+    // Each `buffer` specialization is tested on its own task.
+    auto r = for_args_par(
+        [](auto n)
+        {
+            buffer<n> b;
+            return b.checksum();
+        },
+        sz_v<8>, sz_v<16>, sz_v<32>, sz_v<64>, sz_v<128>, // .
+        sz_v<256>, sz_v<512>, sz_v<1024>);
+
+    assert(std::get<0>(r) == (8 * 7) / 2);
+    assert(std::get<7>(r) == (1024 * 1023) / 2);
+}
+
+void test_heterogeneous()
+{
+    // Results keep their own types, including move-only ones.
+    auto r = for_args_par(
+        [](auto x)
+        {
+            return std::make_unique<decltype(x)>(x);
+        },
+        1, std::string{"two"}, 3.0);
+
+    assert(*std::get<0>(r) == 1);
+    assert(*std::get<1>(r) == "two");
+    assert(*std::get<2>(r) == 3.0);
+
+    auto empty = for_args_par([](auto)
+        {
+        });
+
+    static_assert(std::is_same<decltype(empty), std::tuple<>>{}, "");
+}
+
+void test_void()
+{
+    std::atomic<int> sum{0};
+
+    auto r = for_args_par(
+        [&sum](int x)
+        {
+            sum += x;
+        },
+        1, 2, 3, 4, 5);
+
+    static_assert(std::is_same<std::tuple_element_t<0, decltype(r)>,
+                      par_nothing>{},
+        "");
+
+    assert(sum == 15);
+}
+
+void test_grain()
+{
+    // Elements of the same group are executed in order, by the same
+    // thread.
+    std::mutex mutex;
+    std::set<std::thread::id> group_ids[3];
+
+    auto r = for_args_par<4>(
+        [&](auto i)
+        {
+            std::lock_guard<std::mutex> lock{mutex};
+            group_ids[decltype(i){} / 4].emplace(std::this_thread::get_id());
+
+            return decltype(i){};
+        },
+        sz_v<0>, sz_v<1>, sz_v<2>, sz_v<3>, sz_v<4>, sz_v<5>, sz_v<6>,
+        sz_v<7>, sz_v<8>, sz_v<9>);
+
+    for(const auto& ids : group_ids)
+    {
+        assert(ids.size() == 1);
+    }
+
+    assert(std::get<9>(r) == 9);
+}
+
+void test_exceptions()
+{
+    std::atomic<int> executed{0};
+    bool caught = false;
+
+    try
+    {
+        for_args_par(
+            [&executed](auto x)
+            {
+                ++executed;
+                if(x == 2)
+                {
+                    throw std::runtime_error{"failed"};
+                }
+
+                return x;
+            },
+            0, 1, 2, 3, 4);
+    }
+    catch(const std::runtime_error&)
+    {
+        caught = true;
+    }
+
+    assert(caught);
+    assert(executed == 5);
+}
+
+int main()
+{
+    test_results();
+    test_heterogeneous();
+    test_void();
+    test_grain();
+    test_exceptions();
+
+    std::cout << "ok\n";
+}
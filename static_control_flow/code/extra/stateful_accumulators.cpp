@@ -0,0 +1,198 @@
+// Copyright (c) 2016 Vittorio Romeo
+// License: AFL 3.0 | https://opensource.org/licenses/AFL-3.0
+// http://vittorioromeo.info | vittorio.romeo@outlook.com
+
+
+
+#include <cassert>
+#include <iostream>
+#include <memory>
+#include <utility>
+#include <vector>
+#include "../impl/static_if.hpp"
+#include "../impl/static_for.hpp"
+#include "../impl/static_for_log.hpp"
+
+// Stateful accumulators are moved through the loop: they are never copied
+// unless a state or a bound accumulator is used as an lvalue, and they can
+// be move-only.
+
+int copies = 0;
+
+struct counted_vector
+{
+    std::vector<int> _v;
+
+    counted_vector() = default;
+
+    counted_vector(const counted_vector& rhs) : _v(rhs._v)
+    {
+        ++copies;
+    }
+
+    counted_vector(counted_vector&&) = default;
+
+    counted_vector& operator=(const counted_vector& rhs)
+    {
+        ++copies;
+        _v = rhs._v;
+        return *this;
+    }
+
+    counted_vector& operator=(counted_vector&&) = default;
+};
+
+template <typename TEngine>
+void test_no_copies(TEngine engine)
+{
+    copies = 0;
+
+    auto r = engine([](auto state, auto&& x)
+        {
+            auto acc = std::move(state).accumulator();
+            acc._v.emplace_back(x);
+
+            return state.continue_(std::move(acc));
+        })(counted_vector{})(0, 1, 2, 3, 4, 5, 6, 7, 8, 9);
+
+    assert(copies == 0);
+    assert(r._v.size() == 10);
+    for(int i = 0; i < 10; ++i)
+    {
+        assert(r._v[i] == i);
+    }
+}
+
+template <typename TEngine>
+void test_move_only(TEngine engine)
+{
+    // Counts the arguments equal to `2`, and stops at the first `0`.
+    auto r = engine([](auto state, auto&& x)
+        {
+            return static_if(bool_v<(decltype(x){} == 0)>)
+                .then([](auto s)
+                    {
+                        return std::move(s).break_();
+                    })
+                .else_([](auto s)
+                    {
+                        return static_if(bool_v<(decltype(x){} == 2)>)
+                            .then([](auto ss)
+                                {
+                                    ++*ss.accumulator();
+                                    return std::move(ss).continue_();
+                                })
+                            .else_([](auto ss)
+                                {
+                                    return std::move(ss).continue_();
+                                })(std::move(s));
+                    })(std::move(state));
+        })(std::make_unique<int>(0))(
+        int_v<2>, int_v<1>, int_v<2>, int_v<0>, int_v<2>);
+
+    assert(*r == 2);
+}
+
+template <typename TEngine>
+void test_bound_reuse(TEngine engine)
+{
+    // A bound accumulator called as an lvalue copies it at every call:
+    // every call starts from the same accumulator.
+    auto bound = engine([](auto state, auto&& x)
+        {
+            auto acc = std::move(state).accumulator();
+            acc._v.emplace_back(x);
+
+            return state.continue_(std::move(acc));
+        })(counted_vector{});
+
+    copies = 0;
+    auto r0 = bound(0, 1, 2);
+    auto r1 = bound(3, 4);
+
+    assert(copies == 2);
+    assert(r0._v.size() == 3);
+    assert(r1._v.size() == 2);
+    assert(r1._v[0] == 3);
+}
+
+template <typename TEngine>
+void test_lvalue_state(TEngine engine)
+{
+    // `continue_()` on an lvalue state copies the accumulator, leaving the
+    // state untouched.
+    counted_vector initial;
+    initial._v.emplace_back(7);
+
+    auto r = engine([](auto state, auto&&)
+        {
+            auto next = state.continue_();
+            assert(state.accumulator()._v == next.accumulator()._v);
+
+            return next;
+        })(std::move(initial))(0, 1, 2, 3, 4);
+
+    assert(r._v.size() == 1);
+    assert(r._v[0] == 7);
+}
+
+void test_move_only_branch()
+{
+    // Branches are moved into `static_if`: they can capture move-only
+    // objects.
+    auto p = std::make_unique<int>(42);
+
+    auto r = static_if(bool_v<true>)
+                 .then([p = std::move(p)](auto)
+                     {
+                         return *p;
+                     })
+                 .else_([](auto)
+                     {
+                         return 0;
+                     })(0);
+
+    assert(r == 42);
+}
+
+void test_empty_accumulators()
+{
+    // Empty accumulators are still usable in constant expressions.
+    auto r = static_for_log([](auto state, auto&& x)
+        {
+            return state.continue_(sz_v<( // .
+                decltype(state){}.accumulator() + decltype(x){})>);
+        })(sz_v<0>)(sz_v<1>, sz_v<2>, sz_v<3>, sz_v<4>);
+
+    static_assert(decltype(r){} == 10, "");
+}
+
+int main()
+{
+    auto recursive = [](auto&& body)
+    {
+        return static_for(FWD(body));
+    };
+
+    auto log_depth = [](auto&& body)
+    {
+        return static_for_log(FWD(body));
+    };
+
+    test_no_copies(recursive);
+    test_no_copies(log_depth);
+
+    test_move_only(recursive);
+    test_move_only(log_depth);
+
+    test_bound_reuse(recursive);
+    test_bound_reuse(log_depth);
+
+    test_lvalue_state(recursive);
+    test_lvalue_state(log_depth);
+
+    test_move_only_branch();
+    test_empty_accumulators();
+
+    std::cout << "ok\n";
+}
@@ -0,0 +1,121 @@
+// Copyright (c) 2016 Vittorio Romeo
+// License: AFL 3.0 | https://opensource.org/licenses/AFL-3.0
+// http://vittorioromeo.info | vittorio.romeo@outlook.com
+
+
+
+#include <cassert>
+#include <iostream>
+#include <utility>
+#include "../impl/static_for.hpp"
+#include "../impl/static_for_log.hpp"
+
+// `static_for_log` is a drop-in replacement for `static_for`: both
+// engines must produce the same results for the same loop bodies.
+
+auto sum_body = [](auto state, auto&& x)
+{
+    return state.continue_(sz_v<(                        // .
+        decltype(state){}.accumulator() + decltype(x){} // .
+        )>);
+};
+
+// Stops as soon as the accumulator reaches `50`.
+auto sum_until_50_body = [](auto state, auto&& x)
+{
+    constexpr auto next = decltype(state){}.accumulator() + decltype(x){};
+
+    return static_if(bool_v<(next >= 50)>)
+        .then([](auto s)
+            {
+                return s.break_(sz_v<next>);
+            })
+        .else_([](auto s)
+            {
+                return s.continue_(sz_v<next>);
+            })(state);
+};
+
+template <typename TEngine>
+void test_sum(TEngine engine)
+{
+    auto r0 = engine(sum_body)(sz_v<0>)();
+    static_assert(decltype(r0){} == 0, "");
+
+    auto r1 = engine(sum_body)(sz_v<0>)(sz_v<10>);
+    static_assert(decltype(r1){} == 10, "");
+
+    auto r2 = engine(sum_body)(sz_v<0>)(sz_v<10>, sz_v<20>, sz_v<30>);
+    static_assert(decltype(r2){} == 60, "");
+}
+
+template <typename TEngine>
+void test_break(TEngine engine)
+{
+    auto r0 = engine(sum_until_50_body)(sz_v<0>)( // .
+        sz_v<10>, sz_v<20>, sz_v<30>, sz_v<40>);
+
+    static_assert(decltype(r0){} == 60, "");
+
+    // Arguments after the `break_` are never visited.
+    int visited = 0;
+    auto r1 = engine([&visited](auto state, auto&& x)
+        {
+            ++visited;
+            return sum_until_50_body(state, x);
+        })(sz_v<0>)(sz_v<25>, sz_v<25>, sz_v<1>, sz_v<1>, sz_v<1>);
+
+    static_assert(decltype(r1){} == 50, "");
+    assert(visited == 2);
+}
+
+template <typename TEngine>
+void test_iteration_order(TEngine engine)
+{
+    int next = 0;
+    engine([&next](auto state, auto&& x)
+        {
+            assert(state.iteration() == next);
+            assert(x == next * 10);
+            ++next;
+
+            return state.continue_();
+        })(sz_v<0>)(0, 10, 20, 30, 40, 50, 60);
+
+    assert(next == 7);
+}
+
+// The log-depth engine nests `log2(n)` levels deep: a 1000-element pack
+// compiles with the default template depth limits.
+template <std::size_t... TIs>
+void test_large_pack(std::index_sequence<TIs...>)
+{
+    auto r = static_for_log(sum_body)(sz_v<0>)(sz_v<TIs>...);
+    static_assert(decltype(r){} == (999 * 1000) / 2, "");
+}
+
+int main()
+{
+    auto recursive = [](auto&& body)
+    {
+        return static_for(FWD(body));
+    };
+
+    auto log_depth = [](auto&& body)
+    {
+        return static_for_log(FWD(body));
+    };
+
+    test_sum(recursive);
+    test_sum(log_depth);
+
+    test_break(recursive);
+    test_break(log_depth);
+
+    test_iteration_order(recursive);
+    test_iteration_order(log_depth);
+
+    test_large_pack(std::make_index_sequence<1000>{});
+
+    std::cout << "ok\n";
+}
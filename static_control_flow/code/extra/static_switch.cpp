@@ -0,0 +1,96 @@
+// Copyright (c) 2016 Vittorio Romeo
+// License: AFL 3.0 | https://opensource.org/licenses/AFL-3.0
+// http://vittorioromeo.info | vittorio.romeo@outlook.com
+
+
+
+#include <cassert>
+#include <iostream>
+#include <string>
+#include "../impl/static_if.hpp"
+#include "../impl/static_switch.hpp"
+
+// The `buffer` struct from `p06.cpp`.
+template <std::size_t TBytes>
+struct buffer
+{
+    std::size_t size() const noexcept
+    {
+        return TBytes;
+    }
+};
+
+// A run-time byte count selects the matching `buffer` specialization,
+// without a linear chain of comparisons.
+auto buffer_size(std::size_t i)
+{
+    return static_switch(i)(sz_v<8>, sz_v<16>, sz_v<32>, sz_v<64>,
+        sz_v<128>, sz_v<256>, sz_v<512>, sz_v<1024>)([](auto n)
+        {
+            buffer<n> b;
+            return b.size();
+        });
+}
+
+void test_values()
+{
+    for(std::size_t i = 0; i < 8; ++i)
+    {
+        assert(buffer_size(i) == (std::size_t(8) << i));
+    }
+}
+
+void test_functions()
+{
+    int calls = 0;
+
+    auto f0 = [&calls]
+    {
+        ++calls;
+        return std::string{"zero"};
+    };
+
+    auto f1 = [&calls]
+    {
+        calls += 10;
+        return std::string{"one"};
+    };
+
+    auto call = [](auto& f)
+    {
+        return f();
+    };
+
+    assert(static_switch(0)(f0, f1)(call) == "zero");
+    assert(static_switch(1)(f0, f1)(call) == "one");
+    assert(calls == 11);
+}
+
+void test_common_type()
+{
+    // `int` and `long` results are converted to their common type.
+    auto r = static_switch(1)(int_v<1>, int_v<2>)([](auto x)
+        {
+            return static_if(bool_v<(decltype(x){} == 1)>)
+                .then([](auto)
+                    {
+                        return 1;
+                    })
+                .else_([](auto)
+                    {
+                        return 2l;
+                    })(0);
+        });
+
+    static_assert(std::is_same<decltype(r), long>{}, "");
+    assert(r == 2);
+}
+
+int main()
+{
+    test_values();
+    test_functions();
+    test_common_type();
+
+    std::cout << "ok\n";
+}
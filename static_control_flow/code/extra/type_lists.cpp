@@ -8,6 +8,7 @@
 #include <tuple>
 #include <experimental/tuple>
 #include "../impl/static_for.hpp"
+#include "../impl/type_list.hpp"
 
 void example0()
 {
@@ -53,3 +54,67 @@ void for_tuple(TF&& f, TTuple&& t)
 
     std::experimental::apply(adapted, FWD(t));
 }
+
+// `std::tuple` is convenient for values, but algorithms over its types
+// (e.g. folding with `foldl_step` in `p04.cpp`) instantiate one template
+// per element, recursively. `impl/type_list.hpp` provides the same
+// operations on `mp::type_list`, without recursion.
+
+template <typename T>
+using is_even = bool_<(T{} % 2 == 0)>;
+
+template <typename T>
+using twice = sz_<T{} * 2>;
+
+template <typename TAcc, typename T>
+using plus = sz_<TAcc{} + T{}>;
+
+void example2()
+{
+    using l = mp::type_list<sz_<8>, sz_<16>, sz_<3>, sz_<8>, sz_<5>>;
+
+    static_assert(l::size == 5, "");
+    static_assert(std::is_same<mp::at<l, 2>, sz_<3>>{}, "");
+
+    static_assert(mp::index_of<l, sz_<8>>{} == 0, "");
+    static_assert(mp::index_of<l, sz_<5>>{} == 4, "");
+    static_assert(mp::index_of<l, sz_<7>>{} == l::size, "");
+
+    static_assert(std::is_same<mp::filter<l, is_even>,
+                      mp::type_list<sz_<8>, sz_<16>, sz_<8>>>{},
+        "");
+
+    static_assert(std::is_same<mp::transform<l, twice>,
+                      mp::type_list<sz_<16>, sz_<32>, sz_<6>, sz_<16>,
+                          sz_<10>>>{},
+        "");
+
+    static_assert(mp::fold<l, sz_<0>, plus>{} == 40, "");
+
+    static_assert(std::is_same<mp::unique<l>,
+                      mp::type_list<sz_<8>, sz_<16>, sz_<3>, sz_<5>>>{},
+        "");
+
+    static_assert(std::is_same<mp::unique<mp::type_list<>>,
+                      mp::type_list<>>{},
+        "");
+}
+
+// Large lists only nest a few levels of instantiations.
+template <std::size_t... TIs>
+void example3(std::index_sequence<TIs...>)
+{
+    using l = mp::type_list<sz_<TIs % 500>...>;
+
+    static_assert(mp::unique<l>::size == 500, "");
+    static_assert(mp::fold<l, sz_<0>, plus>{} == 2 * (499 * 500) / 2, "");
+    static_assert(std::is_same<mp::at<l, 999>, sz_<499>>{}, "");
+}
+
+int main()
+{
+    example0();
+    example1();
+    example2();
+    example3(std::make_index_sequence<1000>{});
+}
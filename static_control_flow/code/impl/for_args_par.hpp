@@ -0,0 +1,275 @@
+// Copyright (c) 2016 Vittorio Romeo
+// License: AFL 3.0 | https://opensource.org/licenses/AFL-3.0
+// http://vittorioromeo.info | vittorio.romeo@outlook.com
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "./for_args.hpp"
+#include "./static_switch.hpp"
+
+// Parallel version of `for_args`: the body is executed on every argument
+// concurrently, and the results are joined in a tuple.
+/*
+    // Groups of `2` arguments are executed by the same task.
+    auto results = for_args_par<2>([](auto n)
+        {
+            buffer<n> b;
+            return run_test(b);
+        },
+        sz_v<8>, sz_v<16>, sz_v<32>, sz_v<64>);
+*/
+
+// The arguments are split at compile time in groups of `TGrain` elements,
+// in order to amortize the scheduling cost of small bodies. The groups are
+// picked by a set of worker threads (one per hardware thread, including the
+// calling one) from a shared counter, and dispatched to their instantiation
+// with `static_switch`.
+
+// The body is shared between the workers: it must be safe to invoke it
+// concurrently. Arguments are passed as lvalues. Bodies returning `void`
+// produce a `par_nothing` in the resulting tuple, other results are stored
+// by value. If a body throws, the remaining groups are still executed and
+// the first exception is rethrown on the calling thread.
+
+struct par_nothing
+{
+};
+
+namespace impl
+{
+    template <typename TF, typename T>
+    using par_body_result_type = decltype(std::declval<TF&>()(
+        std::declval<T&>()));
+
+    template <typename TF, typename T>
+    using par_result_type =
+        std::conditional_t<std::is_void<par_body_result_type<TF, T>>{},
+            par_nothing, std::decay_t<par_body_result_type<TF, T>>>;
+
+    template <typename TF, typename T>
+    auto par_call(std::true_type, TF& f, T& x)
+    {
+        f(x);
+        return par_nothing{};
+    }
+
+    template <typename TF, typename T>
+    auto par_call(std::false_type, TF& f, T& x)
+    {
+        return f(x);
+    }
+
+    // Storage for a result that is produced by a worker thread, and moved
+    // in the resulting tuple after all the workers have been joined.
+    template <typename T>
+    class par_slot
+    {
+    private:
+        std::aligned_storage_t<sizeof(T), alignof(T)> _storage;
+        bool _constructed{false};
+
+        auto ptr() noexcept
+        {
+            return reinterpret_cast<T*>(&_storage);
+        }
+
+    public:
+        par_slot() = default;
+
+        par_slot(const par_slot&) = delete;
+        par_slot& operator=(const par_slot&) = delete;
+
+        ~par_slot()
+        {
+            if(_constructed)
+            {
+                ptr()->~T();
+            }
+        }
+
+        template <typename TResult>
+        void set(TResult&& x)
+        {
+            new(&_storage) T(FWD(x));
+            _constructed = true;
+        }
+
+        T get() &&
+        {
+            return std::move(*ptr());
+        }
+    };
+
+    template <std::size_t TGrain, typename TF, typename... Ts>
+    class par_context
+    {
+    private:
+        static constexpr auto arg_count = sizeof...(Ts);
+        static constexpr auto group_count = (arg_count + TGrain - 1) / TGrain;
+
+        TF& _f;
+        std::tuple<Ts&...> _args;
+        std::tuple<par_slot<par_result_type<TF, Ts>>...> _slots;
+
+        std::atomic<std::size_t> _next_group{0};
+        std::mutex _error_mutex;
+        std::exception_ptr _error;
+
+        template <std::size_t TI>
+        void run_arg()
+        {
+            using type = std::tuple_element_t<TI, std::tuple<Ts...>>;
+            using is_void = std::is_void<par_body_result_type<TF, type>>;
+
+            std::get<TI>(_slots).set(
+                par_call(is_void{}, _f, std::get<TI>(_args)));
+        }
+
+        template <std::size_t TBegin, std::size_t... TIs>
+        void run_group_impl(std::index_sequence<TIs...>)
+        {
+            for_args(
+                [this](auto i)
+                {
+                    this->run_arg<TBegin + decltype(i)::value>();
+                },
+                std::integral_constant<std::size_t, TIs>{}...);
+        }
+
+        template <std::size_t TGroup>
+        void run_group()
+        {
+            constexpr auto begin = TGroup * TGrain;
+            constexpr auto end = std::min(begin + TGrain, arg_count);
+
+            run_group_impl<begin>(std::make_index_sequence<end - begin>{});
+        }
+
+        template <std::size_t... TGroups>
+        void work(std::index_sequence<TGroups...>)
+        {
+            for(auto g = _next_group++; g < group_count; g = _next_group++)
+            {
+                try
+                {
+                    static_switch(g)( // .
+                        std::integral_constant<std::size_t, TGroups>{}...)(
+                        [this](auto group)
+                        {
+                            this->run_group<decltype(group)::value>();
+                        });
+                }
+                catch(...)
+                {
+                    std::lock_guard<std::mutex> lock{_error_mutex};
+                    if(!_error)
+                    {
+                        _error = std::current_exception();
+                    }
+                }
+            }
+        }
+
+        void work()
+        {
+            work(std::make_index_sequence<group_count>{});
+        }
+
+        template <std::size_t... TIs>
+        auto collect(std::index_sequence<TIs...>)
+        {
+            return std::tuple<par_result_type<TF, Ts>...>{
+                std::move(std::get<TIs>(_slots)).get()...};
+        }
+
+    public:
+        par_context(TF& f, Ts&... xs) noexcept : _f(f), _args{xs...}
+        {
+        }
+
+        auto run()
+        {
+            auto worker_count = std::min<std::size_t>(
+                std::max(std::thread::hardware_concurrency(), 1u),
+                group_count);
+
+            std::vector<std::thread> workers;
+            workers.reserve(worker_count - 1);
+
+            auto join_all = [&workers]
+            {
+                for(auto& t : workers)
+                {
+                    t.join();
+                }
+            };
+
+            // If a worker cannot be spawned, the ones already started are
+            // joined before the exception propagates.
+            try
+            {
+                for(std::size_t i = 1; i < worker_count; ++i)
+                {
+                    workers.emplace_back([this]
+                        {
+                            this->work();
+                        });
+                }
+            }
+            catch(...)
+            {
+                join_all();
+                throw;
+            }
+
+            work();
+            join_all();
+
+            if(_error)
+            {
+                std::rethrow_exception(_error);
+            }
+
+            return collect(std::index_sequence_for<Ts...>{});
+        }
+    };
+
+    template <std::size_t TGrain, typename TF, typename... Ts>
+    constexpr decltype(par_context<TGrain, TF, Ts...>::arg_count)
+        par_context<TGrain, TF, Ts...>::arg_count;
+
+    template <std::size_t TGrain, typename TF, typename... Ts>
+    constexpr decltype(par_context<TGrain, TF, Ts...>::group_count)
+        par_context<TGrain, TF, Ts...>::group_count;
+
+    template <std::size_t TGrain, typename TF>
+    auto for_args_par_impl(bool_<true>, TF&)
+    {
+        return std::tuple<>{};
+    }
+
+    template <std::size_t TGrain, typename TF, typename... Ts>
+    auto for_args_par_impl(bool_<false>, TF& f, Ts&... xs)
+    {
+        return par_context<TGrain, TF, Ts...>{f, xs...}.run();
+    }
+}
+
+template <std::size_t TGrain = 1, typename TF, typename... Ts>
+auto for_args_par(TF&& f, Ts&&... xs)
+{
+    static_assert(TGrain > 0, "");
+
+    return impl::for_args_par_impl<TGrain>(
+        bool_v<(sizeof...(xs) == 0)>, f, xs...);
+}
@@ -9,13 +9,18 @@
 #include "./static_if.hpp"
 #include "./static_for_state.hpp"
 
+// The accumulator is moved from a state to the next one, and into and out
+// of the `static_if` branches (which take it as an argument instead of
+// capturing it): stateful and move-only accumulators are never copied.
+// Binding an accumulator returns an `impl::bound_accumulator`: calling it as
+// an lvalue copies the accumulator first.
 template <typename TFBody>
 auto static_for(TFBody&& body)
 {
     auto step = [body = FWD(body)](
         auto self, auto state, auto&& x, auto&&... xs)
     {
-        auto next_state = body(state, x);
+        auto next_state = body(std::move(state), x);
 
         constexpr auto last_iteration = bool_v<(sizeof...(xs) == 0)>;
 
@@ -24,32 +29,35 @@ auto static_for(TFBody&& body)
                 impl::action::a_break>{})>;
 
         return static_if(bool_v<(must_break || last_iteration)>)
-            .then([next_state](auto&&)
+            .then([](auto&& xstate, auto&&)
                 {
-                    return next_state.accumulator();
+                    return std::move(xstate).accumulator();
                 })
-            .else_([next_state, state, &xs...](auto&& xself)
+            .else_([&xs...](auto&& xstate, auto&& xself)
                 {
-                    return xself(next_state, xs...);
-                })(self);
+                    return xself(std::move(xstate), xs...);
+                })(std::move(next_state), self);
     };
 
-    return [step = std::move(step)](auto accumulator)
+    auto loop = [step = std::move(step)](auto accumulator, auto&&... xs)
     {
-        return [step, accumulator](auto&&... xs)
-        {
-            return static_if(bool_v<(sizeof...(xs) == 0)>)
-                .then([accumulator](auto&&)
-                    {
-                        return accumulator;
-                    })
-                .else_([accumulator](auto&& xstep, auto&&... ys)
-                    {
-                        auto initial_state = impl::make_state( // .
-                            sz_v<0>, accumulator, impl::action::a_continue{});
-
-                        return y_combinator(xstep)(initial_state, FWD(ys)...);
-                    })(step, FWD(xs)...);
-        };
+        return static_if(bool_v<(sizeof...(xs) == 0)>)
+            .then([](auto&& xacc, auto&&)
+                {
+                    return std::move(xacc);
+                })
+            .else_([](auto&& xacc, auto&& xstep, auto&&... ys)
+                {
+                    auto initial_state = impl::make_state( // .
+                        sz_v<0>, std::move(xacc), impl::action::a_continue{});
+
+                    return y_combinator(xstep)(
+                        std::move(initial_state), FWD(ys)...);
+                })(std::move(accumulator), step, FWD(xs)...);
+    };
+
+    return [loop = std::move(loop)](auto accumulator)
+    {
+        return impl::bind_accumulator(loop, std::move(accumulator));
     };
 }
@@ -0,0 +1,167 @@
+// Copyright (c) 2016 Vittorio Romeo
+// License: AFL 3.0 | https://opensource.org/licenses/AFL-3.0
+// http://vittorioromeo.info | vittorio.romeo@outlook.com
+
+#pragma once
+
+#include <utility>
+#include "./static_if.hpp"
+#include "./static_for_state.hpp"
+
+// Alternative `static_for` engine with log-depth instantiation, with the
+// same interface:
+/*
+    static_for_log([](auto state, auto x)
+        {
+            return state.continue_();
+        })(accumulator)(xs...);
+*/
+
+// Instead of recursing once per argument through `y_combinator` and
+// `static_if`, the arguments are split in two halves: the state returned by
+// the left half is passed to the right half. The nesting depth is
+// logarithmic in the number of arguments (a 1000-element pack only nests 10
+// levels), and no lambda captures are copied at every step. Halves are
+// taken with an `index_sequence` over a flat structure of references (one
+// base class per argument), as `std::tuple` is recursive in some
+// implementations.
+
+// A single-level pack expansion is not possible: the type of the state
+// changes at every step, and C++14 has no fold expressions to chain them.
+
+// `break_` is handled by overload resolution: once a state with the
+// `a_break` action is returned, the remaining ranges are skipped without
+// instantiating the body on their arguments.
+
+namespace impl
+{
+    namespace log_depth
+    {
+        // Reference to the `TI`-th argument.
+        template <std::size_t TI, typename T>
+        struct arg
+        {
+            T& _x;
+        };
+
+        template <typename TIdxs, typename... Ts>
+        struct args;
+
+        template <std::size_t... TIs, typename... Ts>
+        struct args<std::index_sequence<TIs...>, Ts...> : arg<TIs, Ts>...
+        {
+            args(Ts&... xs) noexcept : arg<TIs, Ts>{xs}...
+            {
+            }
+        };
+
+        // Deduces `T` from the only matching base class of `args`.
+        template <std::size_t TI, typename T>
+        auto& get(arg<TI, T>& a) noexcept
+        {
+            return a._x;
+        }
+
+        template <typename... Ts>
+        auto make_args(Ts&... xs) noexcept
+        {
+            return args<std::index_sequence_for<Ts...>, Ts...>{xs...};
+        }
+
+        template <typename TBody, typename TState, typename TArgs,
+            std::size_t... TLs, std::size_t... TRs>
+        auto run_halves(TBody& body, TState s, TArgs& a,
+            std::index_sequence<TLs...>, std::index_sequence<TRs...>);
+
+        // The loop was broken: skip the remaining arguments.
+        template <typename TBody, typename TItr, typename TAcc,
+            typename... Ts>
+        auto run(TBody&, state<TItr, TAcc, action::a_break> s, Ts&...)
+        {
+            return s;
+        }
+
+        // Single argument: execute the body.
+        template <typename TBody, typename TItr, typename TAcc, typename T>
+        auto run(TBody& body, state<TItr, TAcc, action::a_continue> s, T& x)
+        {
+            return body(std::move(s), x);
+        }
+
+        // Two or three arguments: nest the calls directly.
+        template <typename TBody, typename TItr, typename TAcc, typename T0,
+            typename T1>
+        auto run(TBody& body, state<TItr, TAcc, action::a_continue> s,
+            T0& x0, T1& x1)
+        {
+            return run(body, run(body, std::move(s), x0), x1);
+        }
+
+        template <typename TBody, typename TItr, typename TAcc, typename T0,
+            typename T1, typename T2>
+        auto run(TBody& body, state<TItr, TAcc, action::a_continue> s,
+            T0& x0, T1& x1, T2& x2)
+        {
+            return run(
+                body, run(body, run(body, std::move(s), x0), x1), x2);
+        }
+
+        // More arguments: split them in two halves.
+        template <typename TBody, typename TItr, typename TAcc, typename T0,
+            typename T1, typename T2, typename T3, typename... Ts>
+        auto run(TBody& body, state<TItr, TAcc, action::a_continue> s,
+            T0& x0, T1& x1, T2& x2, T3& x3, Ts&... xs)
+        {
+            constexpr auto n = sizeof...(xs) + 4;
+            auto a = make_args(x0, x1, x2, x3, xs...);
+
+            return run_halves(body, std::move(s), a,
+                std::make_index_sequence<n / 2>{},
+                std::make_index_sequence<n - n / 2>{});
+        }
+
+        // Executes the left half, then the right half with the resulting
+        // state. Every level of the recursion only carries the types of its
+        // own arguments.
+        template <typename TBody, typename TState, typename TArgs,
+            std::size_t... TLs, std::size_t... TRs>
+        auto run_halves(TBody& body, TState s, TArgs& a,
+            std::index_sequence<TLs...>, std::index_sequence<TRs...>)
+        {
+            auto next_state = run(body, std::move(s), get<TLs>(a)...);
+            return run(body, std::move(next_state),
+                get<sizeof...(TLs) + TRs>(a)...);
+        }
+
+        template <typename TBody, typename TAcc, typename... Ts>
+        auto static_for_impl(bool_<true>, TBody&, TAcc accumulator, Ts&&...)
+        {
+            return accumulator;
+        }
+
+        template <typename TBody, typename TAcc, typename... Ts>
+        auto static_for_impl(
+            bool_<false>, TBody& body, TAcc accumulator, Ts&&... xs)
+        {
+            auto initial_state = make_state( // .
+                sz_v<0>, std::move(accumulator), action::a_continue{});
+
+            return run(body, std::move(initial_state), xs...).accumulator();
+        }
+    }
+}
+
+template <typename TFBody>
+auto static_for_log(TFBody&& body)
+{
+    auto loop = [body = FWD(body)](auto accumulator, auto&&... xs)
+    {
+        return impl::log_depth::static_for_impl(bool_v<(sizeof...(xs) == 0)>,
+            body, std::move(accumulator), FWD(xs)...);
+    };
+
+    return [loop = std::move(loop)](auto accumulator)
+    {
+        return impl::bind_accumulator(loop, std::move(accumulator));
+    };
+}
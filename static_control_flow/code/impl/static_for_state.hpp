@@ -4,6 +4,8 @@
 
 #pragma once
 
+#include <type_traits>
+#include <utility>
 #include "./static_if.hpp"
 
 namespace impl
@@ -19,18 +21,66 @@ namespace impl
         };
     }
 
-    template <typename TItr, typename TAcc, typename TAction>
-    struct state
+    // Empty accumulators (e.g. `sz_v<...>`) are not stored: they are
+    // recreated on access, which keeps `accumulator()` usable in constant
+    // expressions.
+    template <typename TAcc, bool TEmpty = std::is_empty<TAcc>{}>
+    class accumulator_holder
     {
-        constexpr auto iteration() const noexcept
+    public:
+        constexpr accumulator_holder() noexcept = default;
+
+        constexpr accumulator_holder(TAcc) noexcept
         {
-            return TItr{};
         }
 
         constexpr auto accumulator() const noexcept
         {
             return TAcc{};
         }
+    };
+
+    // Stateful accumulators are stored, and moved from a state to the next
+    // one. They can be move-only.
+    template <typename TAcc>
+    class accumulator_holder<TAcc, false>
+    {
+    private:
+        TAcc _acc;
+
+    public:
+        constexpr accumulator_holder() = default;
+
+        template <typename TAccFwd>
+        constexpr accumulator_holder(TAccFwd&& acc) : _acc(FWD(acc))
+        {
+        }
+
+        constexpr const auto& accumulator() const& noexcept
+        {
+            return _acc;
+        }
+
+        constexpr auto& accumulator() & noexcept
+        {
+            return _acc;
+        }
+
+        constexpr auto accumulator() &&
+        {
+            return std::move(_acc);
+        }
+    };
+
+    template <typename TItr, typename TAcc, typename TAction>
+    struct state : accumulator_holder<TAcc>
+    {
+        using accumulator_holder<TAcc>::accumulator_holder;
+
+        constexpr auto iteration() const noexcept
+        {
+            return TItr{};
+        }
 
         constexpr auto next_action() const noexcept
         {
@@ -38,55 +88,116 @@ namespace impl
         }
 
         template <typename TNewAcc>
-        constexpr auto continue_(TNewAcc) const noexcept;
-
-        constexpr auto continue_() const noexcept;
+        constexpr auto continue_(TNewAcc&&) const;
 
         template <typename TNewAcc>
-        constexpr auto break_(TNewAcc) const noexcept;
+        constexpr auto break_(TNewAcc&&) const;
+
+        // The overloads without arguments keep the current accumulator: it
+        // is copied, unless the state is an rvalue (e.g.
+        // `std::move(state).continue_()`), which moves it out of the state.
+        constexpr auto continue_() const&;
+        constexpr auto continue_() &&;
 
-        constexpr auto break_() const noexcept;
+        constexpr auto break_() const&;
+        constexpr auto break_() &&;
     };
 
     template <typename TItr, typename TAcc, typename TAction>
-    constexpr auto make_state(TItr, TAcc, TAction)
+    constexpr auto make_state(TItr, TAcc&& a, TAction)
     {
-        return state<TItr, TAcc, TAction>{};
+        return state<TItr, std::decay_t<TAcc>, TAction>{FWD(a)};
     }
 
     template <typename TState, typename TAcc, typename TAction>
-    constexpr auto advance_state(TState s, TAcc a, TAction na)
+    constexpr auto advance_state(const TState&, TAcc&& a, TAction na)
+    {
+        using itr_type = decltype(std::declval<const TState&>().iteration());
+        return make_state(sz_v<itr_type{} + 1>, FWD(a), na);
+    }
+
+    template <typename TItr, typename TAcc, typename TAction>
+    template <typename TNewAcc>
+    constexpr auto state<TItr, TAcc, TAction>::continue_( // .
+        TNewAcc&& new_acc) const
     {
-        return make_state(sz_v<s.iteration() + 1>, a, na);
+        return advance_state(*this, FWD(new_acc), action::a_continue{});
     }
 
     template <typename TItr, typename TAcc, typename TAction>
     template <typename TNewAcc>
+    constexpr auto state<TItr, TAcc, TAction>::break_( // .
+        TNewAcc&& new_acc) const
+    {
+        return advance_state(*this, FWD(new_acc), action::a_break{});
+    }
+
+    template <typename TItr, typename TAcc, typename TAction>
     constexpr auto state<TItr, TAcc, TAction>::continue_( // .
-        TNewAcc new_acc) const noexcept
+        ) const&
     {
-        return advance_state(*this, new_acc, action::a_continue{});
+        return continue_(this->accumulator());
     }
 
     template <typename TItr, typename TAcc, typename TAction>
     constexpr auto state<TItr, TAcc, TAction>::continue_( // .
-        ) const noexcept
+        ) &&
     {
-        return continue_(accumulator());
+        return continue_(std::move(*this).accumulator());
     }
 
     template <typename TItr, typename TAcc, typename TAction>
-    template <typename TNewAcc>
     constexpr auto state<TItr, TAcc, TAction>::break_( // .
-        TNewAcc new_acc) const noexcept
+        ) const&
     {
-        return advance_state(*this, new_acc, action::a_break{});
+        return break_(this->accumulator());
     }
 
     template <typename TItr, typename TAcc, typename TAction>
     constexpr auto state<TItr, TAcc, TAction>::break_( // .
-        ) const noexcept
+        ) &&
+    {
+        return break_(std::move(*this).accumulator());
+    }
+
+    // Accumulator bound to a loop, returned by `static_for(body)(acc)`.
+    // `TLoop` executes the loop from an accumulator and the arguments.
+    // Calling an lvalue copies the accumulator, so that every call starts
+    // from the same one (move-only accumulators cannot be called as
+    // lvalues). Calling an rvalue, as in `static_for(body)(acc)(xs...)`,
+    // moves it into the loop.
+    template <typename TLoop, typename TAcc>
+    class bound_accumulator
+    {
+    private:
+        TLoop _loop;
+        TAcc _acc;
+
+    public:
+        template <typename TLoopFwd, typename TAccFwd>
+        constexpr bound_accumulator(TLoopFwd&& loop, TAccFwd&& acc)
+            : _loop(FWD(loop)), _acc(FWD(acc))
+        {
+        }
+
+        template <typename... Ts>
+        constexpr auto operator()(Ts&&... xs) const&
+        {
+            auto acc = _acc;
+            return _loop(std::move(acc), FWD(xs)...);
+        }
+
+        template <typename... Ts>
+        constexpr auto operator()(Ts&&... xs) &&
+        {
+            return _loop(std::move(_acc), FWD(xs)...);
+        }
+    };
+
+    template <typename TLoop, typename TAcc>
+    constexpr auto bind_accumulator(TLoop&& loop, TAcc&& acc)
     {
-        return break_(accumulator());
+        return bound_accumulator<std::decay_t<TLoop>, std::decay_t<TAcc>>{
+            FWD(loop), FWD(acc)};
     }
-}
\ No newline at end of file
+}
@@ -4,6 +4,7 @@
 
 #pragma once
 
+#include <type_traits>
 #include "./fwd.hpp"
 
 template <bool TX>
@@ -128,10 +129,12 @@ namespace impl
         }
     };
 
+    // The branch is moved in the result when it is an rvalue, and copied
+    // otherwise.
     template <typename TF>
     auto make_static_if_result(TF&& f) noexcept
     {
-        return static_if_result<TF>{FWD(f)};
+        return static_if_result<std::decay_t<TF>>{FWD(f)};
     }
 }
 
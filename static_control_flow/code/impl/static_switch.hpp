@@ -0,0 +1,101 @@
+// Copyright (c) 2016 Vittorio Romeo
+// License: AFL 3.0 | https://opensource.org/licenses/AFL-3.0
+// http://vittorioromeo.info | vittorio.romeo@outlook.com
+
+#pragma once
+
+#include <cassert>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include "./fwd.hpp"
+
+// Selects one of a pack of compile-time cases with a run-time index:
+/*
+    // Invokes `f(sz_v<32>)`.
+    static_switch(2)(sz_v<8>, sz_v<16>, sz_v<32>)(f);
+
+    // Cases can be functions as well.
+    static_switch(i)(f0, f1, f2)([](auto& f){ return f(); });
+*/
+
+// The continuation is instantiated once per case: the instantiations are
+// stored in a table of function pointers, built at compile time, which is
+// indexed directly. The cost of a call does not depend on the number of
+// cases. All the instantiations must return the same type, or types with a
+// common type.
+
+namespace impl
+{
+    template <typename TF, typename... TCases>
+    using static_switch_result_type = std::common_type_t<decltype( // .
+        std::declval<TF&>()(std::declval<TCases&>()))...>;
+
+    template <std::size_t TI, typename TResult, typename TF,
+        typename TCases>
+    TResult static_switch_thunk(TF& f, TCases& cases)
+    {
+        return f(std::get<TI>(cases));
+    }
+
+    template <typename... TCases>
+    class static_switch_cases
+    {
+    private:
+        using cases_type = std::tuple<TCases...>;
+
+        std::size_t _idx;
+        cases_type _cases;
+
+        template <typename TF, std::size_t... TIs>
+        auto dispatch(TF& f, std::index_sequence<TIs...>)
+        {
+            using result_type = static_switch_result_type<TF, TCases...>;
+            using thunk_type = result_type (*)(TF&, cases_type&);
+
+            static constexpr thunk_type table[] = {
+                &static_switch_thunk<TIs, result_type, TF, cases_type>...};
+
+            return table[_idx](f, _cases);
+        }
+
+    public:
+        template <typename... TCasesFwd>
+        constexpr static_switch_cases(std::size_t idx, TCasesFwd&&... xs)
+            : _idx{idx}, _cases{FWD(xs)...}
+        {
+        }
+
+        template <typename TF>
+        auto operator()(TF&& f)
+        {
+            return dispatch(f, std::index_sequence_for<TCases...>{});
+        }
+    };
+
+    class static_switch_impl
+    {
+    private:
+        std::size_t _idx;
+
+    public:
+        constexpr static_switch_impl(std::size_t idx) noexcept : _idx{idx}
+        {
+        }
+
+        template <typename... TCases>
+        auto operator()(TCases&&... xs)
+        {
+            static_assert(sizeof...(xs) > 0, "");
+            assert(_idx < sizeof...(xs));
+
+            return static_switch_cases<std::decay_t<TCases>...>{
+                _idx, FWD(xs)...};
+        }
+    };
+}
+
+inline constexpr auto static_switch(std::size_t idx) noexcept
+{
+    return impl::static_switch_impl{idx};
+}
@@ -0,0 +1,279 @@
+// Copyright (c) 2016 Vittorio Romeo
+// License: AFL 3.0 | https://opensource.org/licenses/AFL-3.0
+// http://vittorioromeo.info | vittorio.romeo@outlook.com
+
+#pragma once
+
+#include <type_traits>
+#include <utility>
+
+// Type lists and algorithms over them:
+/*
+    using l = mp::type_list<int, float, int, char>;
+
+    static_assert(std::is_same<mp::at<l, 1>, float>{}, "");
+    static_assert(mp::index_of<l, char>{} == 3, "");
+
+    // `type_list<int, float, char>`
+    using u = mp::unique<l>;
+
+    // `type_list<int, int>`
+    using f = mp::filter<l, std::is_integral>;
+*/
+
+// The algorithms avoid recursive instantiations, whose depth (and cost)
+// grow with the size of the list:
+// * `at` finds the `I`-th element by overload resolution, against a class
+//   deriving from one `indexed<I, T>` base per element.
+// * `index_of`, `filter` and `unique` compute the indices of the selected
+//   elements with `constexpr` functions, then expand them with `at`.
+// * `transform` is a single pack expansion.
+// * `fold` is sequential by nature: it is unrolled by `8` elements, so the
+//   nesting depth is `n / 8` instead of `n`.
+
+namespace mp
+{
+    template <typename... Ts>
+    struct type_list
+    {
+        static constexpr std::size_t size = sizeof...(Ts);
+    };
+
+    template <typename... Ts>
+    constexpr std::size_t type_list<Ts...>::size;
+
+    namespace impl
+    {
+        template <std::size_t TI, typename T>
+        struct indexed
+        {
+            using type = T;
+        };
+
+        template <typename TIdxs, typename... Ts>
+        struct indexer;
+
+        template <std::size_t... TIs, typename... Ts>
+        struct indexer<std::index_sequence<TIs...>, Ts...>
+            : indexed<TIs, Ts>...
+        {
+        };
+
+        // Deduces `T` from the only base class with index `TI`.
+        template <std::size_t TI, typename T>
+        indexed<TI, T> select(const indexed<TI, T>&);
+
+        template <typename TList, std::size_t TI>
+        struct at_impl;
+
+        template <typename... Ts, std::size_t TI>
+        struct at_impl<type_list<Ts...>, TI>
+        {
+            static_assert(TI < sizeof...(Ts), "");
+
+            using indexer_type = indexer<std::index_sequence_for<Ts...>, Ts...>;
+            using type = typename decltype(
+                select<TI>(std::declval<indexer_type>()))::type;
+        };
+
+        // Returns the index of the first `true` in `TMask`, or the size of
+        // the mask.
+        template <bool... TMask>
+        constexpr std::size_t find_first() noexcept
+        {
+            // The trailing `false` avoids zero-sized arrays.
+            constexpr bool mask[] = {TMask..., false};
+
+            for(std::size_t i = 0; i < sizeof...(TMask); ++i)
+            {
+                if(mask[i])
+                {
+                    return i;
+                }
+            }
+
+            return sizeof...(TMask);
+        }
+
+        template <std::size_t TN>
+        struct index_array
+        {
+            std::size_t _data[TN + 1];
+            std::size_t _size;
+        };
+
+        // The indices of the `true` elements of `TMask`.
+        template <bool... TMask>
+        struct mask_indices
+        {
+            static constexpr auto get() noexcept
+            {
+                constexpr bool mask[] = {TMask..., false};
+                index_array<sizeof...(TMask)> result{};
+
+                for(std::size_t i = 0; i < sizeof...(TMask); ++i)
+                {
+                    if(mask[i])
+                    {
+                        result._data[result._size++] = i;
+                    }
+                }
+
+                return result;
+            }
+        };
+
+        // Every type has a distinct `tag` object: types are compared by
+        // comparing the addresses of their tags in a `constexpr` function,
+        // instead of instantiating `std::is_same` for every pair.
+        template <typename T>
+        struct type_id
+        {
+            static constexpr bool tag{};
+        };
+
+        template <typename T>
+        constexpr bool type_id<T>::tag;
+
+        // The indices of the first occurrence of every type in `Ts...`.
+        template <typename... Ts>
+        struct unique_indices
+        {
+            static constexpr auto get() noexcept
+            {
+                constexpr const bool* ids[] = {&type_id<Ts>::tag..., nullptr};
+                index_array<sizeof...(Ts)> result{};
+
+                for(std::size_t i = 0; i < sizeof...(Ts); ++i)
+                {
+                    bool seen = false;
+                    for(std::size_t j = 0; j < i && !seen; ++j)
+                    {
+                        seen = ids[j] == ids[i];
+                    }
+
+                    if(!seen)
+                    {
+                        result._data[result._size++] = i;
+                    }
+                }
+
+                return result;
+            }
+        };
+
+        // The elements of `TList` at the indices returned by
+        // `TIndices::get()`.
+        template <typename TList, typename TIndices>
+        struct select_impl
+        {
+            template <std::size_t... TIs>
+            static auto apply(std::index_sequence<TIs...>) -> type_list<
+                typename at_impl<TList, TIndices::get()._data[TIs]>::type...>;
+
+            using type = decltype(apply(
+                std::make_index_sequence<TIndices::get()._size>{}));
+        };
+
+        template <typename TList, typename T>
+        struct index_of_impl;
+
+        template <typename... Ts, typename T>
+        struct index_of_impl<type_list<Ts...>, T>
+        {
+            using type = std::integral_constant<std::size_t,
+                find_first<std::is_same<T, Ts>{}...>()>;
+        };
+
+        template <typename TList, template <typename> class TPredicate>
+        struct filter_impl;
+
+        template <typename... Ts, template <typename> class TPredicate>
+        struct filter_impl<type_list<Ts...>, TPredicate>
+        {
+            using type = typename select_impl<type_list<Ts...>,
+                mask_indices<static_cast<bool>(
+                    TPredicate<Ts>::value)...>>::type;
+        };
+
+        template <typename TList, template <typename> class TF>
+        struct transform_impl;
+
+        template <typename... Ts, template <typename> class TF>
+        struct transform_impl<type_list<Ts...>, TF>
+        {
+            using type = type_list<TF<Ts>...>;
+        };
+
+        template <template <typename, typename> class TF, typename TAcc,
+            typename... Ts>
+        struct fold_impl
+        {
+            using type = TAcc;
+        };
+
+        template <template <typename, typename> class TF, typename TAcc,
+            typename T0, typename... Ts>
+        struct fold_impl<TF, TAcc, T0, Ts...>
+        {
+            using type = typename fold_impl<TF, TF<TAcc, T0>, Ts...>::type;
+        };
+
+        template <template <typename, typename> class TF, typename TAcc,
+            typename T0, typename T1, typename T2, typename T3, typename T4,
+            typename T5, typename T6, typename T7, typename... Ts>
+        struct fold_impl<TF, TAcc, T0, T1, T2, T3, T4, T5, T6, T7, Ts...>
+        {
+            using half = TF<TF<TF<TF<TAcc, T0>, T1>, T2>, T3>;
+            using step = TF<TF<TF<TF<half, T4>, T5>, T6>, T7>;
+
+            using type = typename fold_impl<TF, step, Ts...>::type;
+        };
+
+        template <typename TList, typename TAcc,
+            template <typename, typename> class TF>
+        struct fold_list_impl;
+
+        template <typename... Ts, typename TAcc,
+            template <typename, typename> class TF>
+        struct fold_list_impl<type_list<Ts...>, TAcc, TF>
+        {
+            using type = typename fold_impl<TF, TAcc, Ts...>::type;
+        };
+
+        template <typename TList>
+        struct unique_list_impl;
+
+        template <typename... Ts>
+        struct unique_list_impl<type_list<Ts...>>
+        {
+            using type = typename select_impl<type_list<Ts...>,
+                unique_indices<Ts...>>::type;
+        };
+    }
+
+    // The `TI`-th element of `TList`.
+    template <typename TList, std::size_t TI>
+    using at = typename impl::at_impl<TList, TI>::type;
+
+    // Index of the first `T` in `TList`, or `TList::size` if absent.
+    template <typename TList, typename T>
+    using index_of = typename impl::index_of_impl<TList, T>::type;
+
+    // The elements of `TList` satisfying `TPredicate<T>::value`.
+    template <typename TList, template <typename> class TPredicate>
+    using filter = typename impl::filter_impl<TList, TPredicate>::type;
+
+    // `TF<T>` for every element of `TList`.
+    template <typename TList, template <typename> class TF>
+    using transform = typename impl::transform_impl<TList, TF>::type;
+
+    // `TF<...TF<TF<TAcc, T0>, T1>..., Tn>`.
+    template <typename TList, typename TAcc,
+        template <typename, typename> class TF>
+    using fold = typename impl::fold_list_impl<TList, TAcc, TF>::type;
+
+    // The first occurrence of every type in `TList`, in order.
+    template <typename TList>
+    using unique = typename impl::unique_list_impl<TList>::type;
+}
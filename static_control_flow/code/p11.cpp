@@ -13,6 +13,7 @@
 
 // "g++ 5.3.0" produces identical assembly from `-O1` onwards.
 // "clang++ 3.7.1" produces identical assembly from `-O2` onwards.
+// (Checked by `./asm/check.sh`, for the cases in `./asm/cases.txt`.)
 
 // Similar results were obtained for `static_if` as well.
 // Both constructs are effectively "cost-free abstractions".